@@ -0,0 +1,114 @@
+# File token cache test for ENABLE_FS_TOKEN_CACHE on the virtual MCU
+#
+# Build the Linux emulator (platformio env EMULATOR_LINUX) with ENABLE_MAIN_LOOP_MODULES,
+# ENABLE_PARSER_MODULES and ENABLE_FS_TOKEN_CACHE and run this script from the emulator folder
+# (the folder is mounted as drive C) with the executable as argument
+#
+#   python3 token_cache.py ./uCNC [number of lines]
+#
+# The test writes a job file and runs it twice in check mode. The first run records the <file>.ucb
+# cache and the second run replays it. The test checks that the word only lines were stored as tokens,
+# that the replay gives no errors and ends in the same parser state and prints both run times.
+
+import os
+import random
+import select
+import subprocess
+import sys
+import time
+
+FILE = 'token_cache.nc'
+CACHE = FILE + '.ucb'
+# magic, source size and timestamp
+CACHE_HEADER_SIZE = 12
+
+
+def read_until(proc, token, timeout):
+    out = b''
+    end = time.time() + timeout
+    while time.time() < end:
+        r, _, _ = select.select([proc.stdout], [], [], 0.01)
+        if r:
+            out += os.read(proc.stdout.fileno(), 65536)
+            if token in out:
+                break
+    return out
+
+
+def write_job(lines):
+    random.seed(1)
+    with open(FILE, 'w') as f:
+        f.write('(token cache test)\n')
+        f.write('G21 G90 G17 M3 S1000\n')
+        for i in range(lines):
+            f.write('G1 X%.3f Y%.3f Z%.3f F%d\n' % (random.uniform(-50, 50), random.uniform(-50, 50), random.uniform(-5, 0), 1000 + i % 500))
+        f.write('G0 X0 Y0 Z0 (back home)\n')
+        f.write('M5\n')
+
+
+def run_job(proc):
+    start = time.time()
+    proc.stdin.write(('$RUN /C/%s\n$G\n' % FILE).encode())
+    out = read_until(proc, b'[GC:', 300)
+    # waits for the end of the parser state
+    end = time.time() + 5
+    while out.find(b']', out.rfind(b'[GC:')) < 0 and time.time() < end:
+        out += read_until(proc, b']', 1)
+    return time.time() - start, out
+
+
+def parser_state(out):
+    start = out.rfind(b'[GC:')
+    return out[start:out.find(b']', start) + 1]
+
+
+def main():
+    exe = sys.argv[1]
+    lines = int(sys.argv[2]) if len(sys.argv) > 2 else 5000
+    write_job(lines)
+    if os.path.exists(CACHE):
+        os.remove(CACHE)
+
+    proc = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, bufsize=0)
+    try:
+        read_until(proc, b'Grbl', 3)
+        proc.stdin.write(b'$X\n$C\n')
+        if b'Enabled' not in read_until(proc, b'Enabled', 5):
+            print('FAIL: could not enter check mode')
+            return 1
+
+        record, out = run_job(proc)
+        if b'error' in out:
+            print('FAIL: the recording run failed')
+            return 1
+        recorded = parser_state(out)
+
+        with open(CACHE, 'rb') as f:
+            cache = f.read()[CACHE_HEADER_SIZE:]
+        tokens = sum(1 for l in cache.split(b'\n') if l and (l[0] & 0x80))
+        # all G1 lines only have words
+        if tokens < lines:
+            print('FAIL: only %d of %d lines were stored as tokens' % (tokens, lines))
+            return 1
+
+        replay, out = run_job(proc)
+        if b'error' in out:
+            print('FAIL: the replay run failed')
+            return 1
+        if parser_state(out) != recorded:
+            print('FAIL: the replay ended in a different parser state')
+            return 1
+        # the replay skips the number parsing
+        if replay >= record:
+            print('FAIL: the replay was not faster than the recording run')
+            return 1
+
+        print('record %.3fs, replay %.3fs (%d source bytes, %d cache bytes)' % (record, replay, os.path.getsize(FILE), len(cache) + CACHE_HEADER_SIZE))
+        print('PASS')
+        return 0
+    finally:
+        proc.kill()
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,29 @@
+(G5 and G5.1 spline tests - requires ENABLE_G5_SPLINES)
+G17 G21 G90 G94 G54
+G0 X0 Y0 Z0
+F500
+(cubic spline with both control points)
+G5 I0 J10 P-10 Q0 X20 Y10
+(continued spline - the first control point is the reflection of the previous one)
+G5 P0 Q-10 X40 Y0
+G5 P-5 Q5 X50 Y10
+(quadratic spline)
+G5.1 I5 J10 X60 Y0
+G5.1 I0 J-10 X70 Y0
+(incremental spline)
+G91
+G5 I5 J5 P-5 Q5 X10 Y0
+G5 P-5 Q-5 X10 Y0
+G90
+(spline in inches)
+G20
+G5 I0.5 J0.5 P-0.5 Q0.5 X4 Y0
+G21
+G0 X0 Y0 Z0
+(probing still works with splines enabled - G38.x must not fail with error:20)
+G38.3 Z-2 F300
+G0 Z0
+(G38.2 ends with a probe fail alarm if the probe is not touched)
+G38.2 Z-2 F100
+G0 Z0
+M2
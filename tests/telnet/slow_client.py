@@ -0,0 +1,142 @@
+# Slow telnet client test for ENABLE_STREAM_TX_QUEUE on the virtual MCU
+#
+# Build the Linux emulator (platformio env EMULATOR_LINUX) with ENABLE_STREAM_TX_QUEUE
+# and run this script from the emulator folder with the executable as argument
+# (the telnet port 23 needs root or cap_net_bind_service)
+#
+#   python3 slow_client.py ./uCNC [telnet port]
+#
+# The emulator console runs the same move twice and times it. While the second move runs
+# a telnet client floods the controller with $# requests (allowed while running) and never reads the answers,
+# so the output to that client stalls until the client is dropped after GRBL_TELNET_TIMEOUT.
+# The test compares both move times to check the motion is not held back by the stalled client
+# and then checks that the console keeps working.
+
+import os
+import select
+import socket
+import subprocess
+import sys
+import time
+
+# long enough for the output to the client to fill the socket buffers (a few MB on Linux) and stall
+MOVE = b'G91 G1 X150 F600\n'
+FLOOD_TIME = 15
+
+
+def read(proc, timeout):
+    out = b''
+    end = time.time() + timeout
+    while time.time() < end:
+        r, _, _ = select.select([proc.stdout], [], [], 0.02)
+        if r:
+            out += os.read(proc.stdout.fileno(), 65536)
+        elif out:
+            break
+    return out
+
+
+def read_until(proc, token, timeout, count=1):
+    out = b''
+    end = time.time() + timeout
+    while time.time() < end:
+        r, _, _ = select.select([proc.stdout], [], [], 0.05)
+        if r:
+            out += os.read(proc.stdout.fileno(), 65536)
+            if out.count(token) >= count:
+                break
+    return out
+
+
+def is_idle(proc):
+    read(proc, 0.01)
+    proc.stdin.write(b'?')
+    out = read_until(proc, b'>', 10)
+    return out.rfind(b'<Idle') >= 0 and out.rfind(b'<Idle') == out.rfind(b'<')
+
+
+def run_move(proc, stall=None):
+    proc.stdin.write(MOVE)
+    if b'ok' not in read_until(proc, b'ok', 5):
+        return None
+    start = time.time()
+    # waits for the motion to start
+    while is_idle(proc) and time.time() - start < 1:
+        time.sleep(0.01)
+    # the move is already in the planner so the flood can't mix with the console line
+    if stall:
+        stall(start)
+    while not is_idle(proc):
+        if time.time() - start > 30:
+            return None
+        time.sleep(0.05)
+    return time.time() - start
+
+
+def main():
+    exe = sys.argv[1]
+    port = int(sys.argv[2]) if len(sys.argv) > 2 else 23
+    proc = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, bufsize=0)
+    try:
+        read_until(proc, b'Grbl', 3)
+        read(proc, 0.5)
+        proc.stdin.write(b'$X\n')
+        if b'ok' not in read_until(proc, b'ok', 5):
+            print('FAIL: could not unlock the controller')
+            return 1
+
+        reference = run_move(proc)
+        if reference is None:
+            print('FAIL: the reference move did not complete')
+            return 1
+
+        client = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        client.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1024)
+        client.connect(('127.0.0.1', port))
+        time.sleep(0.5)
+
+        dropped = []
+
+        def flood(start):
+            # floods the controller with strict output until the stalled client is dropped
+            # one request per millisecond does not overflow the telnet RX buffer
+            client.setblocking(False)
+            while time.time() - start < FLOOD_TIME:
+                try:
+                    client.send(b'$#\n')
+                except BlockingIOError:
+                    pass
+                except (ConnectionResetError, BrokenPipeError):
+                    dropped.append(time.time() - start)
+                    return
+                time.sleep(0.001)
+
+        stalled = run_move(proc, flood)
+        if stalled is None:
+            print('FAIL: the move with the stalled client did not complete')
+            return 1
+
+        client.close()
+        if not dropped:
+            print('FAIL: the client output never stalled')
+            return 1
+
+        print('move time %.2fs (%.2fs with a client stalled and dropped after %.2fs)' % (reference, stalled, dropped[0]))
+        # the output to the stalled client waits up to GRBL_TELNET_TIMEOUT (2s)
+        if stalled > reference + 1.0:
+            print('FAIL: the motion stopped while waiting for the slow client')
+            return 1
+
+        proc.stdin.write(b'G4 P0\n')
+        if b'ok' not in read_until(proc, b'ok', 10):
+            print('FAIL: the console stopped working')
+            return 1
+
+        print('PASS')
+        return 0
+    finally:
+        proc.kill()
+
+
+if __name__ == '__main__':
+    sys.exit(main())
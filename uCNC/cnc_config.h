@@ -336,6 +336,13 @@ extern "C"
 
 	//  #define ENABLE_CANNED_CYCLES
 
+	/**
+	 * Enables G5 (cubic spline) and G5.1 (quadratic spline) motions in the XY plane
+	 * Splines are divided in line segments with a chordal error below the arc tolerance ($12)
+	 * */
+
+	// #define ENABLE_G5_SPLINES
+
 	/**
 	 * accepts the E word (currently is processed has A)
 	 * */
@@ -358,6 +365,12 @@ extern "C"
  * invoked the command
  */
 #define ENABLE_O_CODES_VERBOSE
+/**
+ * uncomment this to store numbered parameters (#1 to #RS274NGC_MAX_USER_VARS) in a small hash table instead of a flat array
+ * only the parameters that were assigned use memory (up to RS274NGC_SPARSE_PARAMS_SIZE)
+ * subroutine calls only store the local parameters they modify instead of copying the whole context
+ */
+// #define ENABLE_RS274NGC_SPARSE_PARAMETERS
 #endif
 
 	/**
@@ -407,6 +420,23 @@ extern "C"
 	// #define ENABLE_MOTION_CONTROL_MODULES
 	// #define ENABLE_PLANNER_MODULES
 
+	/**
+	 * Uncomment to run the main loop (cnc_dotasks) listeners with a cooperative scheduler (requires ENABLE_MAIN_LOOP_MODULES)
+	 * Plain listeners still run on every main loop pass.
+	 * Listeners created with CREATE_SCHEDULED_LISTENER(handler, period_ms, budget_us) run at most once every period
+	 * and only start if their budget still fits in what is left of MAIN_LOOP_TASKS_BUDGET (us) in the pass.
+	 * The ones that don't fit run first in the next pass.
+	 * The step generation (itp_run) runs before each listener whenever the segment buffer is low.
+	 * */
+	// #define ENABLE_MAIN_LOOP_SCHEDULER
+
+	/**
+	 * Uncomment to count the calls and the total and max run time (in us) of every event listener
+	 * $PROF prints the counters of each listener (as <event>.<listener>) and resets them
+	 * This adds a small overhead to each listener call
+	 * */
+	// #define ENABLE_MODULE_PROFILING
+
 	/**
 	 * Settings extensions are enabled by default
 	 * Uncomment to disable this extension.
@@ -432,6 +462,85 @@ extern "C"
 // values bellow 100ms have no effect
 #define STATUS_AUTOMATIC_REPORT_INTERVAL 0
 
+// enables status push subscriptions
+// each stream (serial, telnet, etc...) can subscribe to receive status reports without polling
+// $PS=<ms> sends a status report every <ms> milliseconds
+// $PC=<ms> checks every <ms> milliseconds and only sends the status report if it changed
+// $PS=0 or $PC=0 cancels the subscription
+// #define ENABLE_STATUS_PUSH
+
+// enables the compact status report
+// a stream sends $PD=1 to switch to compact reports (or $PD=0 to go back to the standard report)
+// the compact report only contains the fields that changed since the last report sent to that stream
+// {S:<state>|P:<step pos>,...|F:<feed>,<spindle>|Pn:<pins>}
+// state is the numeric cnc state, positions are in steps and feed is an integer value
+// an empty report {} means that nothing changed
+// #define ENABLE_STATUS_COMPACT
+
+// enables the windowed streaming protocol
+// a stream sends $WS=<n> to stop receiving an ok per line (or $WS=0 to go back to ok per line)
+// lines are numbered implicitly starting at 1 after the $WS command (CR+LF counts as a single line ending)
+// the line number is 16 bit and wraps from 65535 to 0
+// instead of ok the controller sends a cumulative [ACK:<line>] every <n> lines or STREAM_WINDOW_ACK_INTERVAL milliseconds
+// an error is acknowledged immediately with [ACK:<line>|E:<error code>]
+// the host can keep sending lines while the unacknowledged lines fit in the RX buffer (reported in $I)
+// #define ENABLE_STREAM_WINDOW
+#ifndef STREAM_WINDOW_ACK_INTERVAL
+#define STREAM_WINDOW_ACK_INTERVAL 10
+#endif
+
+// enables an independent TX queue for each stream that can report how many chars it can take (currently only telnet)
+// the output is queued and sent to each stream from the main loop as fast as that stream can take it
+// so a slow client (like a stalled telnet connection) does not hold back the main loop
+// all other streams (UART, USB, etc...) are written directly as without this option
+// if the queue of a stream is full status reports are dropped (a queued and unsent status report is replaced by the newest)
+// all other messages (ok, errors, alarms, etc...) are never dropped and wait for room in the queue (the motion keeps running)
+// STREAM_TX_QUEUE_SIZE sets the size of each queue (max 255)
+// #define ENABLE_STREAM_TX_QUEUE
+#ifndef STREAM_TX_QUEUE_SIZE
+#define STREAM_TX_QUEUE_SIZE 128
+#endif
+
+// enables a websocket G-code channel (requires ENABLE_SOCKETS) on WEBSOCKET_GCODE_PORT (default 81)
+// text messages are handled like any other character stream
+// binary messages start with a type byte: 0x01 carries many G-code lines and 0x02 carries realtime commands
+// realtime messages are executed as soon as they arrive, even when the lines buffer is full
+// the controller sends 0x81 credit messages (16-bit little endian byte count) and the sender
+// may only send as many line bytes as it was granted, so it never overflows the RX buffer
+// only the first client to connect gets credits and can send lines or text messages (other clients can only send realtime messages)
+// #define ENABLE_WEBSOCKET_GCODE
+
+// mounts a RAM backed file system drive (RAMFS_DRIVE, default R) with RAMFS_SIZE bytes (default 4096)
+// for up to RAMFS_MAX_FILES files (default 8). The drive is flat (no directories) and only one file
+// can be open for writing at a time. Contents are lost on reset.
+// #define ENABLE_RAMFS
+
+// the first full run of a file from the file system records a pre-tokenized copy (<file>.ucb) next to it
+// the next runs of the same unchanged file (same size and timestamp) replay it without lexing the words
+// lines with comments, expressions or grbl commands are kept as text (requires ENABLE_PARSER_MODULES)
+// replaying skips the number parsing (about 40% less parse time on the Linux emulator in check mode)
+// #define ENABLE_FS_TOKEN_CACHE
+
+// keeps a journal (job.jnl) of the executing line of the file running from the file system so an interrupted job can be resumed with $RESUME
+// each motion block carries the running file line (requires GCODE_PROCESS_LINE_NUMBERS, ENABLE_PARSER_MODULES and ENABLE_MAIN_LOOP_MODULES)
+// #define ENABLE_FS_JOB_JOURNAL
+
+// enables the job runtime estimator (requires ENABLE_PARSER_MODULES)
+// $EST <file> parses a file from the file system in check mode and times the planner blocks
+// with the same trapezoidal profiles used by the interpolator instead of generating steps
+// $EST without a file does the same for a streamed program until $EST is sent again
+// the estimated time, max feed reached and time per tool are reported and check mode is exited (like $C)
+// #define ENABLE_JOB_ESTIMATOR
+
+// stores the settings (NVM) in a log structured journal on a file system drive (NVM_JOURNAL_DRIVE, default C)
+// each settings write only appends the changed bytes as CRC checked records to the journal
+// when the journal reaches NVM_JOURNAL_SIZE it is compacted to a new snapshot in an alternate file
+// the current NVM contents are migrated on the first run (requires a writable file system drive)
+// a full copy of the NVM (NVM_STORAGE_SIZE bytes) is kept in RAM
+// the drive must be mounted before the settings are loaded
+// if it's not the settings fail with a read error and writes fail instead of going to the EEPROM
+// #define ENABLE_NVM_JOURNAL
+
 /**
  *
  * Enable this option to set home has your machine origin.
@@ -684,6 +793,19 @@ extern "C"
 
 #define ENABLE_SYSTEM_INFO
 
+	/**
+	 *
+	 * Enables fast boot.
+	 * The network/wireless coms (and on some MCU's the flash file system) are initialized
+	 * after startup from the main loop, while µCNC is already accepting commands.
+	 * With ENABLE_NVM_JOURNAL the flash file system is still mounted before the settings are loaded.
+	 * Modules can add their own non critical initialization to the cnc_deferred_init event.
+	 * $BOOT prints the time taken by each initialization stage.
+	 *
+	 * */
+
+	// #define ENABLE_FAST_BOOT
+
 	/**
 	 * Compilation specific options
 	 * */
@@ -66,10 +66,91 @@ WEAK_EVENT_HANDLER(cnc_reset)
 }
 
 // event_cnc_dotasks_handler
+#ifndef ENABLE_MAIN_LOOP_SCHEDULER
 WEAK_EVENT_HANDLER(cnc_dotasks)
 {
 	DEFAULT_EVENT_HANDLER(cnc_dotasks);
 }
+#else
+// scheduled listeners (not in the cnc_dotasks event list)
+static cnc_task_t *cnc_tasks;
+
+static bool cnc_dotasks_call(cnc_dotasks_delegate_event_t *ptr, void *args)
+{
+	bool handled = false;
+	if (ptr->fptr != NULL && !CHECKFLAG(ptr->fplock, (g_module_lockguard | LISTENER_RUNNING_LOCK)))
+	{
+		if (itp_buffer_is_low())
+		{
+			itp_run();
+		}
+		SETFLAG(ptr->fplock, LISTENER_RUNNING_LOCK);
+		handled = EVENT_LISTENER_CALL(ptr, args);
+		CLEARFLAG(ptr->fplock, LISTENER_RUNNING_LOCK);
+	}
+	return handled;
+}
+
+// cooperative scheduler
+// the plain listeners run every pass (like the default handler)
+// scheduled listeners then run after their period if their budget still fits in what is left of the pass
+// and the next pass resumes from the first one that didn't fit (the first one due always runs)
+// the step generation runs before each listener whenever the segment buffer is low
+WEAK_EVENT_HANDLER(cnc_dotasks)
+{
+	static cnc_task_t *start = NULL;
+	uint32_t pass_start = mcu_micros();
+	bool handled = false;
+	bool first = true;
+
+	cnc_dotasks_delegate_event_t *ptr = cnc_dotasks_event;
+	while (ptr != NULL && !handled)
+	{
+		handled = cnc_dotasks_call(ptr, args);
+		ptr = ptr->next;
+	}
+
+	uint32_t now = mcu_millis();
+	cnc_task_t *task = (start != NULL) ? start : cnc_tasks;
+	start = NULL;
+	while (task != NULL)
+	{
+		if ((int32_t)(now - task->next_run) >= 0)
+		{
+			// does not fit. runs first in the next pass
+			if (!first && ((mcu_micros() - pass_start) + task->budget) > MAIN_LOOP_TASKS_BUDGET)
+			{
+				start = task;
+				break;
+			}
+			first = false;
+			task->next_run = now + task->period;
+			cnc_dotasks_call(&task->listener, args);
+		}
+		task = task->next;
+	}
+
+	return handled;
+}
+
+void cnc_add_task(cnc_task_t *task)
+{
+	task->next = NULL;
+	EVENT_PROFILE_ADD(&task->listener);
+	if (cnc_tasks == NULL)
+	{
+		cnc_tasks = task;
+		return;
+	}
+
+	cnc_task_t *p = cnc_tasks;
+	while (p->next != NULL)
+	{
+		p = p->next;
+	}
+	p->next = task;
+}
+#endif
 
 // event_cnc_dotasks_handler
 WEAK_EVENT_HANDLER(cnc_io_dotasks)
@@ -96,6 +177,78 @@ WEAK_EVENT_HANDLER(cnc_alarm)
 }
 #endif
 
+#ifdef ENABLE_FAST_BOOT
+#define BOOT_STAGE_MCU 0
+#define BOOT_STAGE_STREAM 1
+#define BOOT_STAGE_MODULES 2
+#define BOOT_STAGE_SETTINGS 3
+#define BOOT_STAGE_MOTION 4
+#define BOOT_STAGE_TOOLS 5
+#define BOOT_STAGE_READY 6
+#define BOOT_STAGE_DEFERRED 7
+#define BOOT_STAGES 8
+static uint32_t cnc_boot_stamp[BOOT_STAGES];
+static uint32_t cnc_boot_network;
+// last listener that is done (listeners are appended so the next ones are still pending)
+static cnc_deferred_init_delegate_event_t *cnc_deferred_init_done;
+#define cnc_boot_stage(stage) cnc_boot_stamp[stage] = mcu_micros()
+
+// event_cnc_deferred_init_handler
+// runs the first pending listener and returns EVENT_HANDLED when all are done
+WEAK_EVENT_HANDLER(cnc_deferred_init)
+{
+	cnc_deferred_init_delegate_event_t *ptr = (cnc_deferred_init_done != NULL) ? cnc_deferred_init_done->next : cnc_deferred_init_event;
+	if (ptr == NULL)
+	{
+		return EVENT_HANDLED;
+	}
+
+	if (!CHECKFLAG(ptr->fplock, (g_module_lockguard | LISTENER_RUNNING_LOCK)))
+	{
+		SETFLAG(ptr->fplock, LISTENER_RUNNING_LOCK);
+		if (EVENT_LISTENER_CALL(ptr, args))
+		{
+			// done. it will not run again
+			cnc_deferred_init_done = ptr;
+		}
+		CLEARFLAG(ptr->fplock, LISTENER_RUNNING_LOCK);
+	}
+	return EVENT_CONTINUE;
+}
+
+static bool cnc_network_deferred_init(void *args)
+{
+	uint32_t start = mcu_micros();
+	cnc_network_init();
+	cnc_boot_network = mcu_micros() - start;
+	return EVENT_HANDLED;
+}
+
+CREATE_EVENT_LISTENER(cnc_deferred_init, cnc_network_deferred_init);
+
+void cnc_boot_profile(void)
+{
+	proto_info("mcu - %luus", cnc_boot_stamp[BOOT_STAGE_MCU]);
+	proto_info("stream - %luus", cnc_boot_stamp[BOOT_STAGE_STREAM] - cnc_boot_stamp[BOOT_STAGE_MCU]);
+	proto_info("modules - %luus", cnc_boot_stamp[BOOT_STAGE_MODULES] - cnc_boot_stamp[BOOT_STAGE_STREAM]);
+	proto_info("settings - %luus", cnc_boot_stamp[BOOT_STAGE_SETTINGS] - cnc_boot_stamp[BOOT_STAGE_MODULES]);
+	proto_info("motion - %luus", cnc_boot_stamp[BOOT_STAGE_MOTION] - cnc_boot_stamp[BOOT_STAGE_SETTINGS]);
+	proto_info("tools - %luus", cnc_boot_stamp[BOOT_STAGE_TOOLS] - cnc_boot_stamp[BOOT_STAGE_MOTION]);
+	proto_info("ready at %luus", cnc_boot_stamp[BOOT_STAGE_READY]);
+	proto_info("network - %luus", cnc_boot_network);
+	if (cnc_boot_stamp[BOOT_STAGE_DEFERRED])
+	{
+		proto_info("deferred done at %luus", cnc_boot_stamp[BOOT_STAGE_DEFERRED]);
+	}
+	else
+	{
+		proto_info("deferred pending");
+	}
+}
+#else
+#define cnc_boot_stage(stage)
+#endif
+
 void cnc_init(void)
 {
 	// initializes cnc state
@@ -107,17 +260,28 @@ void cnc_init(void)
 	// initializes all systems
 	mcu_init();											// mcu
 	mcu_io_reset();										// add custom logic to set pins initial state
+	cnc_boot_stage(BOOT_STAGE_MCU);
 	io_enable_steppers(~g_settings.step_enable_invert); // disables steppers at start
 	io_disable_probe();									// forces probe isr disabling
 	grbl_stream_init();									// serial
+	cnc_boot_stage(BOOT_STAGE_STREAM);
 	mod_init();											// modules
+	cnc_boot_stage(BOOT_STAGE_MODULES);
 	settings_init();									// settings
+	cnc_boot_stage(BOOT_STAGE_SETTINGS);
+#ifndef ENABLE_FAST_BOOT
 	cnc_network_init();									// initialize network and wireless coms
+#else
+	// network and wireless coms are initialized after startup from the main loop
+	ADD_EVENT_LISTENER(cnc_deferred_init, cnc_network_deferred_init);
+#endif
 	itp_init();											// interpolator
 	planner_init();										// motion planner
+	cnc_boot_stage(BOOT_STAGE_MOTION);
 #if TOOL_COUNT > 0
 	tool_init();
 #endif
+	cnc_boot_stage(BOOT_STAGE_TOOLS);
 	if (g_settings.homing_enabled)
 	{
 		cnc_set_exec_state(EXEC_POSITION_MAYBE_LOST);
@@ -129,6 +293,9 @@ void __attribute__((weak)) cnc_network_init(void)
 #ifdef ENABLE_SOCKETS
 	mcu_network_init();
 	telnet_sock = telnet_start(&telnet_proto, 23, mcu_telnet_onrecv);
+#ifdef ENABLE_WEBSOCKET_GCODE
+	mcu_ws_gcode_start();
+#endif
 #endif
 #ifdef MCU_HAS_BLUETOOTH
 	mcu_bt_init();
@@ -168,6 +335,12 @@ void cnc_run(void)
 	}
 
 	cnc_state.loop_state = LOOP_RUNNING;
+#ifdef ENABLE_FAST_BOOT
+	if (!cnc_boot_stamp[BOOT_STAGE_READY])
+	{
+		cnc_boot_stage(BOOT_STAGE_READY);
+	}
+#endif
 	for (;;)
 	{
 		cnc_parse_cmd();
@@ -216,6 +389,9 @@ uint8_t cnc_parse_cmd(void)
 	if (grbl_stream_available())
 	{
 		// protocol_echo();
+#ifdef ENABLE_STREAM_WINDOW
+		bool windowed = grbl_stream_window_active();
+#endif
 		uint8_t c = grbl_stream_peek();
 		switch (c)
 		{
@@ -224,6 +400,14 @@ uint8_t cnc_parse_cmd(void)
 			error = STATUS_OVERFLOW;
 			break;
 		case EOL: // not necessary but faster to catch empty lines and windows newline (CR+LF)
+#ifdef ENABLE_STREAM_WINDOW
+			// the LF of a CR+LF is not a new line
+			if (windowed && grbl_stream_window_crlf())
+			{
+				grbl_stream_getc();
+				return STATUS_OK;
+			}
+#endif
 			grbl_stream_getc();
 			break;
 		default:
@@ -243,7 +427,14 @@ uint8_t cnc_parse_cmd(void)
 		// runs any rt command in queue
 		// this catches for example a ?\n situation sent by some GUI like UGS
 		cnc_exec_rt_commands();
-		proto_error(error);
+#ifdef ENABLE_STREAM_WINDOW
+		if (windowed)
+		{
+			proto_window_ack(error);
+		}
+		else
+#endif
+			proto_error(error);
 		DBGLOG("[CNC] cmd parsed error=%hu", error);
 		if (error)
 		{
@@ -264,7 +455,30 @@ bool cnc_dotasks(void)
 	// run io basic tasks
 	cnc_io_dotasks();
 
+#ifdef ENABLE_STREAM_TX_QUEUE
+	// sends the queued output to each stream
+	grbl_stream_tx_flush();
+#endif
+
 	cnc_exec_rt_commands(); // executes all pending realtime commands
+#ifdef ENABLE_STATUS_PUSH
+	proto_status_push(); // sends the status to the subscribed streams
+#endif
+#ifdef ENABLE_STREAM_WINDOW
+	proto_window_flush(); // sends the batched acks of windowed streams
+#endif
+
+#ifdef ENABLE_FAST_BOOT
+	// finishes the non critical initializations while already accepting commands
+	// listeners added later also run
+	if (cnc_state.loop_state != LOOP_STARTUP_RESET)
+	{
+		if (EVENT_INVOKE(cnc_deferred_init, NULL) && !cnc_boot_stamp[BOOT_STAGE_DEFERRED])
+		{
+			cnc_boot_stage(BOOT_STAGE_DEFERRED);
+		}
+	}
+#endif
 
 	// let µCNC finnish startup/reset code
 	if (cnc_state.loop_state == LOOP_STARTUP_RESET)
@@ -199,6 +199,33 @@ extern "C"
 #endif
 #ifndef cnc_modules_dotasks
 #define cnc_modules_dotasks() modules_dotasks()
+#endif
+#ifdef ENABLE_MAIN_LOOP_SCHEDULER
+// time (us) each main loop pass can use to run the cnc_dotasks listeners
+#ifndef MAIN_LOOP_TASKS_BUDGET
+#define MAIN_LOOP_TASKS_BUDGET 1000
+#endif
+	// main loop listener that runs at most once every period (ms)
+	// budget is the expected run time (us) used to fit it in the main loop pass time budget
+	// scheduled listeners are kept in their own list and not in the cnc_dotasks event list
+	typedef struct cnc_task_
+	{
+		cnc_dotasks_delegate_event_t listener;
+		struct cnc_task_ *next;
+		uint16_t period;
+		uint16_t budget;
+		uint32_t next_run;
+	} cnc_task_t;
+	void cnc_add_task(cnc_task_t *task);
+#define CREATE_SCHEDULED_LISTENER(handler, period_ms, budget_us) __attribute__((used)) cnc_task_t cnc_task_##handler = {{&handler, LISTENER_NO_LOCK, NULL EVENT_PROFILE_INIT(cnc_dotasks, handler)}, NULL, period_ms, budget_us, 0}
+#define ADD_SCHEDULED_LISTENER(handler)       \
+	{                                         \
+		extern cnc_task_t cnc_task_##handler; \
+		cnc_add_task(&cnc_task_##handler);    \
+	}
+#else
+#define CREATE_SCHEDULED_LISTENER(handler, period_ms, budget_us) CREATE_EVENT_LISTENER(cnc_dotasks, handler)
+#define ADD_SCHEDULED_LISTENER(handler) ADD_EVENT_LISTENER(cnc_dotasks, handler)
 #endif
 	// event_cnc_io_dotasks_handler
 	DECL_EVENT_HANDLER(cnc_io_dotasks);
@@ -210,6 +237,15 @@ extern "C"
 	DECL_EVENT_HANDLER(cnc_alarm);
 #endif
 
+#ifdef ENABLE_FAST_BOOT
+	// event_cnc_deferred_init_handler
+	// listeners run one at a time (in the order they were added) from the main loop after startup
+	// each returns EVENT_HANDLED when done or EVENT_CONTINUE to be called again in the next pass
+	DECL_EVENT_HANDLER(cnc_deferred_init);
+	// prints the time taken by each initialization stage
+	void cnc_boot_profile(void);
+#endif
+
 #ifndef ucnc_init
 #define ucnc_init cnc_init
 #endif
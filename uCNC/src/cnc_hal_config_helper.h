@@ -2209,6 +2209,53 @@ typedef uint16_t step_t;
 #error "Invalid config option STATUS_AUTOMATIC_REPORT_INTERVAL must be set between 0 and 1000"
 #endif
 
+#if (defined(ENABLE_STATUS_PUSH) && defined(DISABLE_MULTISTREAM_SERIAL))
+#error "ENABLE_STATUS_PUSH requires multistream serial"
+#endif
+#if (defined(ENABLE_STATUS_COMPACT) && defined(DISABLE_MULTISTREAM_SERIAL))
+#error "ENABLE_STATUS_COMPACT requires multistream serial"
+#endif
+#if (defined(ENABLE_STATUS_PUSH) || defined(ENABLE_STATUS_COMPACT))
+#define ENABLE_STATUS_ROUTING
+#endif
+#if (defined(ENABLE_STREAM_WINDOW) && defined(DISABLE_MULTISTREAM_SERIAL))
+#error "ENABLE_STREAM_WINDOW requires multistream serial"
+#endif
+#if (STREAM_WINDOW_ACK_INTERVAL < 1 || STREAM_WINDOW_ACK_INTERVAL > 1000)
+#error "Invalid config option STREAM_WINDOW_ACK_INTERVAL must be set between 1 and 1000"
+#endif
+#if (defined(ENABLE_STREAM_TX_QUEUE) && defined(DISABLE_MULTISTREAM_SERIAL))
+#error "ENABLE_STREAM_TX_QUEUE requires multistream serial"
+#endif
+#if (defined(ENABLE_WEBSOCKET_GCODE) && (defined(DISABLE_MULTISTREAM_SERIAL) || !defined(ENABLE_SOCKETS)))
+#error "ENABLE_WEBSOCKET_GCODE requires sockets and multistream serial"
+#endif
+#ifndef WEBSOCKET_GCODE_TX_BUFFER_SIZE
+#define WEBSOCKET_GCODE_TX_BUFFER_SIZE 128
+#endif
+#if (defined(ENABLE_FS_TOKEN_CACHE) && !defined(ENABLE_PARSER_MODULES))
+#error "ENABLE_FS_TOKEN_CACHE requires ENABLE_PARSER_MODULES"
+#endif
+// the per token parser events are only invoked when something uses them
+#if (defined(ENABLE_FS_TOKEN_CACHE) && !defined(ENABLE_PARSER_TOKEN_EVENTS))
+#define ENABLE_PARSER_TOKEN_EVENTS
+#endif
+#if (defined(ENABLE_PARSER_TOKEN_EVENTS) && !defined(ENABLE_PARSER_MODULES))
+#error "ENABLE_PARSER_TOKEN_EVENTS requires ENABLE_PARSER_MODULES"
+#endif
+#if (defined(ENABLE_FS_JOB_JOURNAL) && (!defined(GCODE_PROCESS_LINE_NUMBERS) || !defined(ENABLE_PARSER_MODULES) || !defined(ENABLE_MAIN_LOOP_MODULES)))
+#error "ENABLE_FS_JOB_JOURNAL requires GCODE_PROCESS_LINE_NUMBERS, ENABLE_PARSER_MODULES and ENABLE_MAIN_LOOP_MODULES"
+#endif
+#if (defined(ENABLE_JOB_ESTIMATOR) && !defined(ENABLE_PARSER_MODULES))
+#error "ENABLE_JOB_ESTIMATOR requires ENABLE_PARSER_MODULES"
+#endif
+#if (defined(ENABLE_MAIN_LOOP_SCHEDULER) && !defined(ENABLE_MAIN_LOOP_MODULES))
+#error "ENABLE_MAIN_LOOP_SCHEDULER requires ENABLE_MAIN_LOOP_MODULES"
+#endif
+#if (STREAM_TX_QUEUE_SIZE < 16 || STREAM_TX_QUEUE_SIZE > 255)
+#error "Invalid config option STREAM_TX_QUEUE_SIZE must be set between 16 and 255"
+#endif
+
 #if defined(ENABLE_AXIS_AUTOLEVEL) || defined(IS_DELTA_KINEMATICS) || defined(ENABLE_XY_SIMULTANEOUS_HOMING)
 #define ENABLE_MULTI_STEP_HOMING
 #endif
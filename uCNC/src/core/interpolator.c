@@ -368,6 +368,97 @@ void itp_unlock(bool *lock)
 #endif
 }
 
+#ifdef ENABLE_JOB_ESTIMATOR
+static bool itp_estimating;
+static itp_estimate_t itp_estimate_data;
+
+// time (in seconds) to travel a distance (in steps) starting at a speed and with a constant acceleration (both in steps per second)
+static float itp_estimate_ramp(float speed, float acceleration, float distance)
+{
+	float final_speed_sqr = fast_flt_pow2(speed) + fast_flt_mul2(acceleration * distance);
+	float final_speed = (final_speed_sqr > 0) ? fast_flt_sqrt(final_speed_sqr) : 0;
+	return ABS(final_speed - speed) * fast_flt_inv(ABS(acceleration));
+}
+
+// times the first planner block with the same trapezoidal profile computed by itp_run and discards it
+static void itp_estimate_block(uint8_t tool)
+{
+	planner_block_t *block = planner_get_block();
+	float exit_speed_sqr = planner_get_block_exit_speed_sqr();
+	float junction_speed_sqr = planner_get_block_top_speed(exit_speed_sqr);
+	float junction_speed = fast_flt_sqrt(junction_speed_sqr);
+	float current_speed = fast_flt_sqrt(block->entry_feed_sqr);
+	float accel_inv = fast_flt_inv(block->acceleration);
+	float remaining_steps = (float)block->steps[block->main_stepper];
+
+	// acceleration (or deacceleration) to the junction speed
+	float accel_dist = MIN(fast_flt_div2(ABS(junction_speed_sqr - block->entry_feed_sqr) * accel_inv), remaining_steps);
+	float t = itp_estimate_ramp(current_speed, (junction_speed_sqr < block->entry_feed_sqr) ? -block->acceleration : block->acceleration, accel_dist);
+	remaining_steps -= accel_dist;
+
+	// deacceleration to the exit speed
+	if (junction_speed_sqr > exit_speed_sqr)
+	{
+		float deaccel_dist = MIN(fast_flt_div2((junction_speed_sqr - exit_speed_sqr) * accel_inv), remaining_steps);
+		t += itp_estimate_ramp(junction_speed, -block->acceleration, deaccel_dist);
+		remaining_steps -= deaccel_dist;
+	}
+
+	// constant speed
+	if (junction_speed > 0)
+	{
+		t += remaining_steps * fast_flt_inv(junction_speed);
+	}
+
+	itp_estimate_data.time += t;
+#if TOOL_COUNT > 1
+	itp_estimate_data.tool_time[MIN(tool, TOOL_COUNT)] += t;
+#endif
+	itp_estimate_data.max_feed = MAX(itp_estimate_data.max_feed, junction_speed * block->feed_conversion);
+	// the block ends at the exit speed (carried over to the next block entry)
+	block->entry_feed_sqr = MIN(exit_speed_sqr, junction_speed_sqr);
+	planner_discard_block();
+}
+
+// the tool of the blocks in the planner (a tool change always syncs the planner first)
+static uint8_t itp_estimate_tool(void)
+{
+#if TOOL_COUNT > 1
+	uint8_t modalgroups[14];
+	uint16_t feed;
+	uint16_t spindle;
+	parser_get_modes(modalgroups, &feed, &spindle);
+	return modalgroups[11];
+#else
+	return 0;
+#endif
+}
+
+void itp_estimate_start(void)
+{
+	itp_sync();
+	memset(&itp_estimate_data, 0, sizeof(itp_estimate_t));
+	itp_estimating = true;
+}
+
+void itp_estimate_stop(itp_estimate_t *result)
+{
+	itp_sync();
+	itp_estimating = false;
+	memcpy(result, &itp_estimate_data, sizeof(itp_estimate_t));
+}
+
+bool itp_is_estimating(void)
+{
+	return itp_estimating;
+}
+
+void itp_estimate_dwell(uint16_t dwell)
+{
+	itp_estimate_data.time += 0.001f * dwell;
+}
+#endif
+
 void itp_run(void)
 {
 	// conversion vars
@@ -409,6 +500,20 @@ void itp_run(void)
 #endif
 
 	bool release_mutex __attribute__((__cleanup__(itp_unlock), unused));
+
+#ifdef ENABLE_JOB_ESTIMATOR
+	if (itp_estimating)
+	{
+		// keeps the planner full like a running job so that the blocks are timed with the same lookahead
+		uint8_t tool = itp_estimate_tool();
+		while (planner_buffer_is_full())
+		{
+			itp_estimate_block(tool);
+		}
+		return;
+	}
+#endif
+
 	planner_block_t *block = itp_cur_plan_block;
 	itp_segment_t *sgm = NULL;
 
@@ -439,6 +544,9 @@ void itp_run(void)
 			memset(&itp_blk_data[itp_blk_data_write], 0, sizeof(itp_block_t));
 #ifdef GCODE_PROCESS_LINE_NUMBERS
 			itp_blk_data[itp_blk_data_write].line = block->line;
+#ifdef ENABLE_FS_JOB_JOURNAL
+			itp_blk_data[itp_blk_data_write].file_line = block->file_line;
+#endif
 #endif
 
 			// reset dirbits
@@ -938,6 +1046,9 @@ void itp_clear(void)
 #endif
 	itp_blk_clear();
 	itp_sgm_clear();
+#ifdef ENABLE_JOB_ESTIMATOR
+	itp_estimating = false;
+#endif
 #ifdef MCU_HAS_RTOS
 	BIN_SEMPH_UNLOCK(itp_mutex);
 #else
@@ -1007,10 +1118,46 @@ bool itp_is_empty(void)
 	return (itp_sgm_is_empty() && (itp_rt_sgm == NULL));
 }
 
+#ifdef ENABLE_MAIN_LOOP_SCHEDULER
+bool itp_buffer_is_low(void)
+{
+	uint8_t write, read, fill;
+
+	write = itp_sgm_data_write;
+	read = itp_sgm_data_read;
+	fill = (write >= read) ? (write - read) : (INTERPOLATOR_BUFFER_SIZE - read + write);
+	return (fill <= (INTERPOLATOR_BUFFER_SIZE >> 1));
+}
+#endif
+
 // flushes all motions from all systems (planner or interpolator)
 // used to make a sync motion
 uint8_t itp_sync(void)
 {
+#ifdef ENABLE_JOB_ESTIMATOR
+	if (itp_estimating)
+	{
+#ifdef MCU_HAS_RTOS
+		BIN_SEMPH_LOCK(itp_mutex);
+#else
+		while (itp_mutex)
+			;
+		itp_mutex = 1;
+#endif
+		uint8_t tool = itp_estimate_tool();
+		while (!planner_buffer_is_empty())
+		{
+			itp_estimate_block(tool);
+		}
+#ifdef MCU_HAS_RTOS
+		BIN_SEMPH_UNLOCK(itp_mutex);
+#else
+		itp_mutex = 0;
+#endif
+		return STATUS_OK;
+	}
+#endif
+
 	while (!itp_is_empty() || !planner_buffer_is_empty())
 	{
 		if (!cnc_dotasks())
@@ -1047,6 +1194,13 @@ uint32_t itp_get_rt_line_number(void)
 {
 	return ((itp_sgm_data[itp_sgm_data_read].block != NULL) ? itp_sgm_data[itp_sgm_data_read].block->line : 0);
 }
+
+#ifdef ENABLE_FS_JOB_JOURNAL
+uint32_t itp_get_rt_file_line(void)
+{
+	return ((itp_sgm_data[itp_sgm_data_read].block != NULL) ? itp_sgm_data[itp_sgm_data_read].block->file_line : 0);
+}
+#endif
 #endif
 
 // always fires after pulse
@@ -60,6 +60,9 @@ extern "C"
 		step_t errors[STEPPER_COUNT];
 #ifdef GCODE_PROCESS_LINE_NUMBERS
 		uint32_t line;
+#ifdef ENABLE_FS_JOB_JOURNAL
+		uint32_t file_line;
+#endif
 #endif
 	} itp_block_t;
 
@@ -112,6 +115,28 @@ extern "C"
 #endif
 #ifdef GCODE_PROCESS_LINE_NUMBERS
 	uint32_t itp_get_rt_line_number(void);
+#ifdef ENABLE_FS_JOB_JOURNAL
+	uint32_t itp_get_rt_file_line(void);
+#endif
+#endif
+#ifdef ENABLE_MAIN_LOOP_SCHEDULER
+	// the segment buffer is at or below half
+	bool itp_buffer_is_low(void);
+#endif
+#ifdef ENABLE_JOB_ESTIMATOR
+	typedef struct itp_estimate_
+	{
+		float time;		// seconds
+		float max_feed; // mm/min
+#if TOOL_COUNT > 1
+		float tool_time[TOOL_COUNT + 1];
+#endif
+	} itp_estimate_t;
+	// while estimating the planner blocks are timed instead of executed
+	void itp_estimate_start(void);
+	void itp_estimate_stop(itp_estimate_t *result);
+	bool itp_is_estimating(void);
+	void itp_estimate_dwell(uint16_t dwell);
 #endif
 #ifdef ENABLE_RT_SYNC_MOTIONS
 	// extern volatile int32_t itp_sync_step_counter;
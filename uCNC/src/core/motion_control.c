@@ -60,8 +60,19 @@
 #endif
 #endif
 
+#ifdef ENABLE_G5_SPLINES
+// minimum curve parameter step (limits the number of segments of a single spline)
+#ifndef MC_SPLINE_MIN_STEP
+#define MC_SPLINE_MIN_STEP 0.001f
+#endif
+#endif
+
 static bool mc_flush_pending;
 static bool mc_checkmode;
+#ifdef ENABLE_JOB_ESTIMATOR
+// the check mode fast path does not update the step position
+static bool mc_step_pos_outdated;
+#endif
 static int32_t mc_last_step_pos[STEPPER_COUNT];
 static float mc_last_target[AXIS_COUNT];
 // static float mc_prev_target_dir[AXIS_COUNT];
@@ -203,7 +214,12 @@ static uint8_t mc_line_segment(int32_t *step_new_pos, motion_data_t *block_data)
 		return STATUS_OK;
 	}
 
+#ifdef ENABLE_JOB_ESTIMATOR
+	// the job estimator runs in check mode but times the planner blocks
+	if (!mc_checkmode || itp_is_estimating())
+#else
 	if (!mc_checkmode) // check mode (gcode simulation) doesn't send code to planner
+#endif
 	{
 #ifdef ENABLE_BACKLASH_COMPENSATION
 		// checks if any of the linear actuators there is a shift in direction
@@ -254,6 +270,14 @@ static uint8_t mc_line_segment(int32_t *step_new_pos, motion_data_t *block_data)
 		}
 #endif
 
+#ifdef ENABLE_JOB_ESTIMATOR
+		// times the oldest block right away instead of waiting for the interpolator task
+		if (itp_is_estimating())
+		{
+			itp_run();
+		}
+#endif
+
 		bool mc_flushed = false;
 		while (planner_buffer_is_full() && !mc_flushed)
 		{
@@ -347,6 +371,34 @@ uint8_t mc_line(float *target, motion_data_t *block_data)
 		}
 	}
 
+	// check mode (gcode simulation) only validates the target (soft limits) and tracks the position
+	// the job estimator needs the planner blocks and takes the full path
+#ifdef ENABLE_JOB_ESTIMATOR
+	if (mc_checkmode && !itp_is_estimating())
+#else
+	if (mc_checkmode)
+#endif
+	{
+#ifdef ENABLE_G39_H_MAPPING
+		// unmodify target
+		target[AXIS_TOOL] -= target_hmap_offset;
+#endif
+		memcpy(mc_last_target, target, sizeof(mc_last_target));
+#ifdef ENABLE_JOB_ESTIMATOR
+		mc_step_pos_outdated = true;
+#endif
+		block_data->max_accel = 0;
+		return STATUS_OK;
+	}
+
+#ifdef ENABLE_JOB_ESTIMATOR
+	if (mc_step_pos_outdated)
+	{
+		mc_step_pos_outdated = false;
+		kinematics_coordinates_to_steps(mc_last_target, mc_last_step_pos);
+	}
+#endif
+
 #ifdef ENABLE_EMBROIDERY
 	if ((tool_get_mode() & EMBROIDERY_MODE) && !block_data->spindle)
 	{
@@ -474,6 +526,13 @@ uint8_t mc_line(float *target, motion_data_t *block_data)
 		}
 		max_feed *= inv_dist;
 		max_accel *= inv_dist;
+
+		// the feed of curve segments is already limited by the curvature
+		// the junction between segments is treated as a straight junction
+		if (CHECKFLAG(block_data->motion_mode, MOTIONCONTROL_MODE_CURVE_SEGMENT))
+		{
+			block_data->cos_theta = 1;
+		}
 	}
 
 #if defined(ABC_INDEP_FEED_CALC) && (AXIS_COUNT > 3)
@@ -714,8 +773,14 @@ uint8_t mc_arc(float *target, float center_offset_a, float center_offset_b, floa
 	float radiusangle = radius * arc_angle;
 	radiusangle = fast_flt_div2(radiusangle);
 	float diameter = fast_flt_mul2(radius);
-	uint16_t segment_count = floor(fabs(radiusangle) / sqrt(g_settings.arc_tolerance * (diameter - g_settings.arc_tolerance)));
-	float arc_per_sgm = (segment_count != 0) ? arc_angle / segment_count : arc_angle;
+	// number of segments so that the chordal error (sagitta) of each segment does not exceed the arc tolerance
+	uint16_t segment_count = 1;
+	if (diameter > g_settings.arc_tolerance)
+	{
+		float segments = ceilf(fabs(radiusangle) / sqrt(g_settings.arc_tolerance * (diameter - g_settings.arc_tolerance)));
+		segment_count = (uint16_t)CLAMP(1, segments, UINT16_MAX);
+	}
+	float arc_per_sgm = arc_angle / segment_count;
 
 	// for all other axis finds the linear motion distance
 	float increment[AXIS_COUNT];
@@ -734,6 +799,12 @@ uint8_t mc_arc(float *target, float center_offset_a, float center_offset_b, floa
 		// split the required time to complete the motion with the number of segments
 		block_data->feed *= segment_count;
 	}
+	else
+	{
+		// limits the feed by the centripetal acceleration (v^2/r <= a) for the whole arc
+		float max_arc_feed = sqrtf(MIN(g_settings.acceleration[axis_0], g_settings.acceleration[axis_1]) * radius) * 60.0f;
+		block_data->feed = MIN(block_data->feed, max_arc_feed);
+	}
 
 	// calculates an aproximation to sine and cosine of the angle segment
 	// improves the error for the cosine by calculating an extra term of the taylor series at the expence of an extra multiplication and addition
@@ -795,11 +866,113 @@ uint8_t mc_arc(float *target, float center_offset_a, float center_offset_b, floa
 		}
 
 		uint8_t error = mc_line(mc_position, block_data);
+		// the following segments junctions are already limited by the arc feed
+		SETFLAG(block_data->motion_mode, MOTIONCONTROL_MODE_CURVE_SEGMENT);
 		if (error)
 		{
+			CLEARFLAG(block_data->motion_mode, MOTIONCONTROL_MODE_CURVE_SEGMENT);
 			return error;
 		}
 	}
+	// Ensure last segment arrives at target location.
+	uint8_t error = mc_line(target, block_data);
+	CLEARFLAG(block_data->motion_mode, MOTIONCONTROL_MODE_CURVE_SEGMENT);
+	return error;
+}
+#endif
+
+#ifdef ENABLE_G5_SPLINES
+/**
+ * Flattens a cubic Bezier curve in the axis_0/axis_1 plane
+ * The control points are given as offsets (P1 from the current position and P2 from the target)
+ * Other axis are linearly interpolated along the curve parameter
+ *
+ * The curve is divided adaptively so that the chordal error of each segment does not exceed the arc tolerance
+ * For a parameter step h the chordal error is bounded by h^2/8 * max|B''| and since B'' is linear for a cubic
+ * the maximum over the step is at one of its ends
+ */
+static float mc_spline_step(float t, float *d0, float *d1)
+{
+	// 8 * tolerance / 6 (B''(t) = 6 * ((1 - t) * d0 + t * d1))
+	float tol = g_settings.arc_tolerance * (8.0f / 6.0f);
+	float mt = 1.0f - t;
+	float dd_a = mt * d0[0] + t * d1[0];
+	float dd_b = mt * d0[1] + t * d1[1];
+	float dd = sqrtf(dd_a * dd_a + dd_b * dd_b);
+	float h = (dd > 0) ? sqrtf(tol / dd) : 1.0f;
+	if (h > mt)
+	{
+		h = mt;
+	}
+
+	// checks the curvature at the end of the step and shrinks it if needed
+	t += h;
+	mt = 1.0f - t;
+	dd_a = mt * d0[0] + t * d1[0];
+	dd_b = mt * d0[1] + t * d1[1];
+	float dd_end = sqrtf(dd_a * dd_a + dd_b * dd_b);
+	if (dd_end > dd)
+	{
+		h = sqrtf(tol / dd_end);
+	}
+
+	// prevents stalling with very small tolerances
+	return MAX(h, MC_SPLINE_MIN_STEP);
+}
+
+uint8_t mc_spline(float *target, float p1_offset_a, float p1_offset_b, float p2_offset_a, float p2_offset_b, uint8_t axis_0, uint8_t axis_1, motion_data_t *block_data)
+{
+	float mc_position[AXIS_COUNT];
+	float start[AXIS_COUNT];
+
+	// copy motion control last position
+	mc_get_position(start);
+
+	// control points relative to the start position
+	float p1[2] = {p1_offset_a, p1_offset_b};
+	float p3[2] = {target[axis_0] - start[axis_0], target[axis_1] - start[axis_1]};
+	float p2[2] = {p3[0] + p2_offset_a, p3[1] + p2_offset_b};
+	// second derivative terms at t=0 and t=1
+	float d0[2] = {p2[0] - 2 * p1[0], p2[1] - 2 * p1[1]};
+	float d1[2] = {p1[0] - 2 * p2[0] + p3[0], p1[1] - 2 * p2[1] + p3[1]};
+
+	if (CHECKFLAG(block_data->motion_mode, MOTIONCONTROL_MODE_INVERSEFEED))
+	{
+		// split the required time to complete the motion with the number of segments
+		uint16_t segment_count = 0;
+		for (float t = 0; t < 1.0f; t += mc_spline_step(t, d0, d1))
+		{
+			segment_count++;
+		}
+		block_data->feed *= segment_count;
+	}
+
+	float t = mc_spline_step(0, d0, d1);
+	while (t < 1.0f)
+	{
+		float mt = 1.0f - t;
+		float b1 = 3 * mt * mt * t;
+		float b2 = 3 * mt * t * t;
+		float b3 = t * t * t;
+
+		for (uint8_t i = AXIS_COUNT; i != 0;)
+		{
+			i--;
+			mc_position[i] = start[i] + (target[i] - start[i]) * t;
+		}
+
+		mc_position[axis_0] = start[axis_0] + b1 * p1[0] + b2 * p2[0] + b3 * p3[0];
+		mc_position[axis_1] = start[axis_1] + b1 * p1[1] + b2 * p2[1] + b3 * p3[1];
+
+		uint8_t error = mc_line(mc_position, block_data);
+		if (error)
+		{
+			return error;
+		}
+
+		t += mc_spline_step(t, d0, d1);
+	}
+
 	// Ensure last segment arrives at target location.
 	return mc_line(target, block_data);
 }
@@ -815,6 +988,13 @@ uint8_t mc_dwell(motion_data_t *block_data)
 		cnc_dwell_ms(block_data->dwell);
 		cnc_clear_exec_state(EXEC_DWELL);
 	}
+#ifdef ENABLE_JOB_ESTIMATOR
+	else if (itp_is_estimating())
+	{
+		itp_sync();
+		itp_estimate_dwell(block_data->dwell);
+	}
+#endif
 
 	return STATUS_OK;
 }
@@ -1163,6 +1343,9 @@ void mc_get_position(float *target)
 
 void mc_sync_position(void)
 {
+#ifdef ENABLE_JOB_ESTIMATOR
+	mc_step_pos_outdated = false;
+#endif
 	itp_get_rt_position(mc_last_step_pos);
 	kinematics_steps_to_coordinates(mc_last_step_pos, mc_last_target);
 	parser_sync_position();
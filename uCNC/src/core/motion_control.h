@@ -34,6 +34,8 @@ extern "C"
 #define MOTIONCONTROL_MODE_PAUSEPROGRAM 4
 #define MOTIONCONTROL_MODE_PAUSEPROGRAM_CONDITIONAL 8
 #define MOTIONCONTROL_MODE_APPLY_HMAP 16
+// segment of a curve with a feed already limited by the curvature (junction with the previous segment is not limited)
+#define MOTIONCONTROL_MODE_CURVE_SEGMENT 32
 
 #define MOTIONCONTROL_PROBE_INVERT 1
 #define MOTIONCONTROL_PROBE_NOALARM_ONFAIL 2
@@ -65,6 +67,10 @@ extern "C"
 	{
 #ifdef GCODE_PROCESS_LINE_NUMBERS
 		uint32_t line;
+#ifdef ENABLE_FS_JOB_JOURNAL
+		// line of the running file (set by the file system module)
+		uint32_t file_line;
+#endif
 #endif
 		step_t steps[STEPPER_COUNT];
 		uint8_t dirbits;
@@ -102,6 +108,9 @@ extern "C"
 #ifndef DISABLE_ARC_SUPPORT
 	uint8_t mc_arc(float *target, float center_offset_a, float center_offset_b, float radius, uint8_t axis_0, uint8_t axis_1, bool isclockwise, motion_data_t *block_data);
 #endif
+#ifdef ENABLE_G5_SPLINES
+	uint8_t mc_spline(float *target, float p1_offset_a, float p1_offset_b, float p2_offset_a, float p2_offset_b, uint8_t axis_0, uint8_t axis_1, motion_data_t *block_data);
+#endif
 
 	// sync motions
 	uint8_t mc_dwell(motion_data_t *block_data);
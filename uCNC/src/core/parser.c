@@ -47,6 +47,11 @@ static uint8_t parser_wco_counter;
 static float g92permanentoffset[AXIS_COUNT];
 static int32_t rt_probe_step_pos[STEPPER_COUNT];
 static float parser_last_pos[AXIS_COUNT];
+#ifdef ENABLE_G5_SPLINES
+// last G5 second control point offset (used to continue a spline without I and J)
+static float parser_spline_last_offset[2];
+static bool parser_spline_continue;
+#endif
 
 #ifndef DISABLE_HOME_SUPPORT
 #define ADDITIONAL_COORDINATES 2
@@ -86,6 +91,13 @@ extern bool o_code_end_subrotine(void);
 extern bool o_code_returned;
 extern float o_code_return_value;
 extern uint8_t o_code_stack_index;
+#ifdef ENABLE_O_CODES
+extern uint8_t o_code_stack_context_index;
+#endif
+#ifdef ENABLE_RS274NGC_SPARSE_PARAMETERS
+static uint16_t parser_sparse_params_count;
+static bool parser_sparse_param_is_new(uint16_t param, float value);
+#endif
 #endif
 
 #ifdef ENABLE_CANNED_CYCLES
@@ -129,6 +141,20 @@ WEAK_EVENT_HANDLER(parse_token)
 	DEFAULT_EVENT_HANDLER(parse_token);
 }
 
+#ifdef ENABLE_PARSER_TOKEN_EVENTS
+// event_parse_token_fetch_handler
+WEAK_EVENT_HANDLER(parse_token_fetch)
+{
+	DEFAULT_EVENT_HANDLER(parse_token_fetch);
+}
+
+// event_parse_token_lexed_handler
+WEAK_EVENT_HANDLER(parse_token_lexed)
+{
+	DEFAULT_EVENT_HANDLER(parse_token_lexed);
+}
+#endif
+
 // event_parser_get_modes_handler
 WEAK_EVENT_HANDLER(parser_get_modes)
 {
@@ -671,6 +697,71 @@ static uint8_t parser_grbl_command(void)
 				}
 			}
 			break;
+#if (defined(ENABLE_STATUS_ROUTING) || defined(ENABLE_MODULE_PROFILING))
+		case 'P':
+#ifdef ENABLE_MODULE_PROFILING
+			if (grbl_cmd_str[1] == 'R' && grbl_cmd_str[2] == 'O' && grbl_cmd_str[3] == 'F' && grbl_cmd_len == 4 && c == EOL)
+			{
+				return GRBL_SEND_MODULE_PROFILE;
+			}
+#endif
+#ifdef ENABLE_STATUS_ROUTING
+			// status report options for the current stream
+			if (c == '=' && grbl_cmd_len == 2)
+			{
+				float val = 0;
+				error = parser_get_float(&val);
+				if (!error || (error & NUMBER_ISFLOAT) || val > 65535 || val < 0 || grbl_stream_getc() != EOL)
+				{
+					return STATUS_INVALID_STATEMENT;
+				}
+				switch (grbl_cmd_str[1])
+				{
+#ifdef ENABLE_STATUS_PUSH
+				case 'S':
+				case 'C':
+					grbl_stream_status_subscribe((uint16_t)val, (grbl_cmd_str[1] == 'C'));
+					return STATUS_OK;
+#endif
+#ifdef ENABLE_STATUS_COMPACT
+				case 'D':
+					if (val > 1)
+					{
+						return STATUS_INVALID_STATEMENT;
+					}
+					grbl_stream_status_compact((val != 0));
+					return STATUS_OK;
+#endif
+				}
+				return STATUS_INVALID_STATEMENT;
+			}
+#endif
+			break;
+#endif
+#ifdef ENABLE_STREAM_WINDOW
+		case 'W':
+			// windowed streaming protocol for the current stream
+			if (grbl_cmd_str[1] == 'S' && c == '=' && grbl_cmd_len == 2)
+			{
+				float val = 0;
+				error = parser_get_float(&val);
+				if (!error || (error & NUMBER_ISFLOAT) || val > 255 || val < 0 || grbl_stream_getc() != EOL)
+				{
+					return STATUS_INVALID_STATEMENT;
+				}
+				grbl_stream_window((uint8_t)val);
+				return STATUS_OK;
+			}
+			break;
+#endif
+#ifdef ENABLE_FAST_BOOT
+		case 'B':
+			if (grbl_cmd_str[1] == 'O' && grbl_cmd_str[2] == 'O' && grbl_cmd_str[3] == 'T' && grbl_cmd_len == 4 && c == EOL)
+			{
+				return GRBL_SEND_BOOT_PROFILE;
+			}
+			break;
+#endif
 #ifdef ENABLE_EXTRA_SETTINGS_CMDS
 		case 'S':
 			// new settings command
@@ -783,7 +874,7 @@ static uint8_t parser_grbl_exec_code(uint8_t code)
 	case GRBL_PRINT_PARAM:
 		if (parser_get_float(&value) == NUMBER_OK
 #ifdef ENABLE_NAMED_PARAMETERS
-			|| parser_get_namedparam_id(&value) == NUMBER_OK
+			|| parser_get_namedparam_id(&value, false) == NUMBER_OK
 #endif
 		)
 		{
@@ -818,6 +909,16 @@ static uint8_t parser_grbl_exec_code(uint8_t code)
 		break;
 #endif
 #endif
+#ifdef ENABLE_FAST_BOOT
+	case GRBL_SEND_BOOT_PROFILE:
+		cnc_boot_profile();
+		break;
+#endif
+#ifdef ENABLE_MODULE_PROFILING
+	case GRBL_SEND_MODULE_PROFILE:
+		mod_profile_report();
+		break;
+#endif
 #ifdef ENABLE_PARSER_MODULES
 	case GRBL_SYSTEM_CMD_EXTENDED:
 		break;
@@ -898,7 +999,11 @@ static uint8_t parser_fetch_command(parser_state_t *new_state, parser_words_t *w
 		{
 #ifdef ENABLE_RS274NGC_EXPRESSIONS
 		case '#':
-			if ((value < 1) || (value > RS274NGC_MAX_USER_VARS) || ((int)floorf(value) != value))
+			if (((value < 1) || (value > RS274NGC_MAX_USER_VARS) || ((int)floorf(value) != value))
+#ifdef ENABLE_NAMED_PARAMETERS
+				&& !RS274NGC_IS_USER_NAMED_PARAM(value)
+#endif
+			)
 			{
 				return STATUS_GCODE_MAX_VALUE_EXCEEDED;
 			}
@@ -914,6 +1019,36 @@ static uint8_t parser_fetch_command(parser_state_t *new_state, parser_words_t *w
 			new_state->modified_params[new_state->modified_params_count].id = (uint16_t)value;
 			new_state->modified_params[new_state->modified_params_count].value = assign_val;
 			new_state->modified_params_count++;
+#ifdef ENABLE_RS274NGC_SPARSE_PARAMETERS
+			// only assignments that create a new entry need a free slot
+			// overwrites and values that fall back to the inherited value (delete) always fit
+			if (parser_sparse_param_is_new((uint16_t)value, assign_val))
+			{
+				uint16_t new_entries = 0;
+				for (uint8_t i = 0; i < new_state->modified_params_count; i++)
+				{
+					uint16_t id = new_state->modified_params[i].id;
+					bool last = true;
+					// the last assignment of the same parameter in the line is the one that is stored
+					for (uint8_t j = i + 1; j < new_state->modified_params_count; j++)
+					{
+						if (new_state->modified_params[j].id == id)
+						{
+							last = false;
+							break;
+						}
+					}
+					if (last && parser_sparse_param_is_new(id, new_state->modified_params[i].value))
+					{
+						new_entries++;
+					}
+				}
+				if ((RS274NGC_SPARSE_PARAMS_SIZE - parser_sparse_params_count) < new_entries)
+				{
+					return STATUS_PARAMETERS_STORAGE_FULL;
+				}
+			}
+#endif
 			break;
 #ifdef ENABLE_O_CODES
 		case 'O':
@@ -1173,6 +1308,50 @@ static uint8_t parser_validate_command(parser_state_t *new_state, parser_words_t
 				break;
 			}
 			break;
+#endif
+#ifdef ENABLE_G5_SPLINES
+		case G5:
+			if (new_state->groups.plane != G17)
+			{
+				return STATUS_INVALID_PLANE_SELECTED;
+			}
+
+			if (!CHECKFLAG(cmd->words, GCODE_XYPLANE_AXIS))
+			{
+				return STATUS_GCODE_NO_AXIS_WORDS_IN_PLANE;
+			}
+
+			if (new_state->groups.motion_mantissa)
+			{
+				// G5.1 needs at least one of the control point offsets
+				if (!CHECKFLAG(cmd->words, GCODE_IJPLANE_AXIS))
+				{
+					return STATUS_GCODE_NO_OFFSETS_IN_PLANE;
+				}
+				break;
+			}
+
+			// G5 needs P and Q and I and J (both or none)
+			// I and J can be omitted if the previous motion was also a G5
+			if ((cmd->words & (GCODE_WORD_P | GCODE_WORD_Q)) != (GCODE_WORD_P | GCODE_WORD_Q))
+			{
+				return STATUS_GCODE_VALUE_WORD_MISSING;
+			}
+
+			switch (cmd->words & GCODE_IJPLANE_AXIS)
+			{
+			case 0:
+				if (!parser_spline_continue)
+				{
+					return STATUS_GCODE_VALUE_WORD_MISSING;
+				}
+				__FALL_THROUGH__
+			case GCODE_IJPLANE_AXIS:
+				break;
+			default:
+				return STATUS_GCODE_VALUE_WORD_MISSING;
+			}
+			break;
 #endif
 		case G80: // G80 and
 			if (has_axis)
@@ -1972,6 +2151,60 @@ static uint8_t parser_exec_command(parser_state_t *new_state, parser_words_t *wo
 			}
 			break;
 #endif
+#ifdef ENABLE_G5_SPLINES
+		case G5:
+			if (block_data.feed == 0)
+			{
+				return STATUS_FEED_NOT_SET;
+			}
+			else
+			{
+				float p1_offset_a, p1_offset_b, p2_offset_a, p2_offset_b;
+				if (new_state->groups.motion_mantissa)
+				{
+					// G5.1 quadratic curve is converted to the equivalent cubic curve
+					// P1 = P0 + 2/3 * (Q - P0) and P2 = P3 + 2/3 * (Q - P3)
+					p1_offset_a = words->ijk[0] * (2.0f / 3.0f);
+					p1_offset_b = words->ijk[1] * (2.0f / 3.0f);
+					p2_offset_a = (words->ijk[0] - (target[AXIS_X] - parser_last_pos[AXIS_X])) * (2.0f / 3.0f);
+					p2_offset_b = (words->ijk[1] - (target[AXIS_Y] - parser_last_pos[AXIS_Y])) * (2.0f / 3.0f);
+				}
+				else
+				{
+					if (new_state->groups.units == G20)
+					{
+						words->p *= INCH_MM_MULT;
+						words->d *= INCH_MM_MULT;
+					}
+
+					if (CHECKFLAG(cmd->words, GCODE_IJPLANE_AXIS))
+					{
+						p1_offset_a = words->ijk[0];
+						p1_offset_b = words->ijk[1];
+					}
+					else
+					{
+						// the first control point is the reflection of the previous spline last control point
+						p1_offset_a = -parser_spline_last_offset[0];
+						p1_offset_b = -parser_spline_last_offset[1];
+					}
+
+					p2_offset_a = words->p;
+					p2_offset_b = words->d;
+				}
+
+				error = mc_spline(target, p1_offset_a, p1_offset_b, p2_offset_a, p2_offset_b, AXIS_X, AXIS_Y, &block_data);
+				DBGLOG("[PARSER] spline err=%hu", error);
+				// only a spline that was executed can be continued
+				parser_spline_continue = (!new_state->groups.motion_mantissa && error == STATUS_OK);
+				if (parser_spline_continue)
+				{
+					parser_spline_last_offset[0] = p2_offset_a;
+					parser_spline_last_offset[1] = p2_offset_b;
+				}
+			}
+			break;
+#endif
 #ifndef DISABLE_PROBING_SUPPORT
 		case G38: // G38.2
 				  // G38.3
@@ -2030,6 +2263,14 @@ static uint8_t parser_exec_command(parser_state_t *new_state, parser_words_t *wo
 #endif
 		}
 
+#ifdef ENABLE_G5_SPLINES
+		// only a G5 following another G5 can omit I and J
+		if (new_state->groups.motion != G5)
+		{
+			parser_spline_continue = false;
+		}
+#endif
+
 #ifdef ENABLE_PARSER_MODULES
 		EVENT_INVOKE(gcode_after_motion, &args);
 #endif
@@ -2162,7 +2403,12 @@ static uint8_t parser_gcode_command(bool is_jogging)
 		// stores the new parameters
 		for (uint8_t i = 0; i < next_state.modified_params_count; i++)
 		{
-			parser_set_parameter(next_state.modified_params[i].id, next_state.modified_params[i].value);
+			if (!parser_set_parameter(next_state.modified_params[i].id, next_state.modified_params[i].value))
+			{
+				// the remaining state is still updated since the block was already executed
+				result = STATUS_PARAMETERS_STORAGE_FULL;
+				break;
+			}
 		}
 #endif
 		// if everything went ok updates the parser modal groups and position
@@ -2340,17 +2586,24 @@ uint8_t parser_get_float(float *value)
 
 static uint8_t parser_get_token(uint8_t *word, float *value)
 {
-// this flushes leading white chars and also takes care of processing comments
-#ifndef ENABLE_RS274NGC_EXPRESSIONS
-	uint8_t c = parser_get_next_preprocessed(false);
-#else
-	uint8_t c = parser_backtrack;
+	uint8_t c = 0;
+#ifdef ENABLE_RS274NGC_EXPRESSIONS
+	c = parser_backtrack;
 	parser_backtrack = 0;
+#endif
+#ifdef ENABLE_PARSER_TOKEN_EVENTS
+	parser_token_args_t token_args = {word, value};
+	// event_parse_token_fetch_handler
+	if (!c && EVENT_INVOKE(parse_token_fetch, &token_args))
+	{
+		return STATUS_OK;
+	}
+#endif
+	// this flushes leading white chars and also takes care of processing comments
 	if (!c)
 	{
 		c = parser_get_next_preprocessed(false);
 	}
-#endif
 
 	// if other uint8_t starts tokenization
 	c = TOUPPER(c);
@@ -2359,15 +2612,34 @@ static uint8_t parser_get_token(uint8_t *word, float *value)
 	switch (c)
 	{
 	case EOL: // EOL
+#ifdef ENABLE_PARSER_TOKEN_EVENTS
+		// event_parse_token_lexed_handler
+		EVENT_INVOKE(parse_token_lexed, &token_args);
+#endif
 		return STATUS_OK;
 	case OVF:
 		return STATUS_OVERFLOW;
 #ifdef ENABLE_RS274NGC_EXPRESSIONS
 	case '#':
+#ifdef ENABLE_NAMED_PARAMETERS
+		// assigning a named parameter creates it if it does not exist
+		if (parser_get_next_preprocessed(true) == '<')
+		{
+			if (parser_get_namedparam_id(value, true) != NUMBER_OK)
+			{
+				return STATUS_PARAMETERS_STORAGE_FULL;
+			}
+		}
+		else if (parser_get_float(value) != NUMBER_OK)
+		{
+			return STATUS_INVALID_STATEMENT;
+		}
+#else
 		if (parser_get_float(value) != NUMBER_OK)
 		{
 			return STATUS_INVALID_STATEMENT;
 		}
+#endif
 		c = parser_get_next_preprocessed(false);
 		if (c != '=')
 		{
@@ -2388,7 +2660,10 @@ static uint8_t parser_get_token(uint8_t *word, float *value)
 			{
 				return STATUS_BAD_NUMBER_FORMAT;
 			}
-
+#ifdef ENABLE_PARSER_TOKEN_EVENTS
+			// event_parse_token_lexed_handler
+			EVENT_INVOKE(parse_token_lexed, &token_args);
+#endif
 			return STATUS_OK;
 		}
 // event_parse_token_handler
@@ -2423,6 +2698,9 @@ static uint8_t parser_gcode_word(uint8_t code, uint8_t mantissa, parser_state_t
 		case 59:
 		case 61:
 		case 92:
+#ifdef ENABLE_G5_SPLINES
+		case 5:
+#endif
 			break;
 		default:
 			return STATUS_GCODE_UNSUPPORTED_COMMAND;
@@ -2442,6 +2720,14 @@ static uint8_t parser_gcode_word(uint8_t code, uint8_t mantissa, parser_state_t
 #ifdef ENABLE_G39_H_MAPPING
 	case 39:
 #endif
+#endif
+#ifdef ENABLE_G5_SPLINES
+	case 5: // check if 5 or 5.1 (G38.x and G39 also fall through here)
+		if (code == 5 && mantissa > 1)
+		{
+			return STATUS_GCODE_UNSUPPORTED_COMMAND;
+		}
+		__FALL_THROUGH__
 #endif
 	case 0:
 	case 1:
@@ -2888,6 +3174,9 @@ void parser_reset(bool fullreset)
 	parser_state.groups.stopping = 0;					  // resets all stopping commands (M0,M1,M2,M30,M60)
 	parser_state.groups.coord_system = G54;				  // G54
 	parser_state.groups.plane = G17;					  // G17
+#ifdef ENABLE_G5_SPLINES
+	parser_spline_continue = false;
+#endif
 	parser_state.groups.feed_speed_ovr_bypass = M48;	  // M48
 	parser_state.groups.cutter_radius_compensation = G40; // G40
 	parser_state.groups.distance_mode = G90;			  // G90
@@ -3375,7 +3664,174 @@ uint8_t parser_exec_command_block(parser_state_t *new_state, parser_words_t *wor
  */
 #ifdef ENABLE_RS274NGC_EXPRESSIONS
 
+#ifndef ENABLE_RS274NGC_SPARSE_PARAMETERS
 float g_parser_num_params[RS274NGC_MAX_USER_VARS];
+#else
+/**
+ * Sparse numbered parameters
+ * Parameters are stored in an open addressed hash table (linear probing) keyed by the parameter id and scope.
+ * Global parameters live in scope 0. Local parameters (#1 to #30) written inside a subrotine are stored
+ * in the scope of the call depth (copy-on-write) and shadow the caller values until the subrotine returns.
+ * A parameter that is not stored reads as the inherited value (or 0 for scope 0).
+ */
+typedef struct parser_sparse_param_
+{
+	uint16_t id;
+	uint8_t scope;
+	float value;
+} parser_sparse_param_t;
+
+#define SPARSE_PARAMS_MASK (RS274NGC_SPARSE_PARAMS_SIZE - 1)
+static parser_sparse_param_t parser_sparse_params[RS274NGC_SPARSE_PARAMS_SIZE];
+
+static FORCEINLINE uint16_t parser_sparse_param_hash(uint16_t id, uint8_t scope)
+{
+	// fibonacci hashing
+	uint32_t key = ((uint32_t)scope << 16) | id;
+	return (uint16_t)((key * 2654435769UL) >> 16) & SPARSE_PARAMS_MASK;
+}
+
+static int16_t parser_sparse_param_find(uint16_t id, uint8_t scope)
+{
+	uint16_t i = parser_sparse_param_hash(id, scope);
+	for (uint16_t n = 0; n < RS274NGC_SPARSE_PARAMS_SIZE; n++)
+	{
+		parser_sparse_param_t *p = &parser_sparse_params[i];
+		if (!p->id)
+		{
+			break;
+		}
+		if (p->id == id && p->scope == scope)
+		{
+			return i;
+		}
+		i = (i + 1) & SPARSE_PARAMS_MASK;
+	}
+
+	return -1;
+}
+
+// removes an entry and shifts back the following entries of the same cluster
+static void parser_sparse_param_remove(uint16_t i)
+{
+	uint16_t j = i;
+	parser_sparse_params_count--;
+	for (;;)
+	{
+		parser_sparse_params[i].id = 0;
+		for (;;)
+		{
+			j = (j + 1) & SPARSE_PARAMS_MASK;
+			if (!parser_sparse_params[j].id)
+			{
+				return;
+			}
+			uint16_t k = parser_sparse_param_hash(parser_sparse_params[j].id, parser_sparse_params[j].scope);
+			// the entry can stay if it's home slot is cyclically between i and j
+			if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+			{
+				continue;
+			}
+			break;
+		}
+		parser_sparse_params[i] = parser_sparse_params[j];
+		i = j;
+	}
+}
+
+static FORCEINLINE uint8_t parser_sparse_param_scope(uint16_t param)
+{
+#ifdef ENABLE_O_CODES
+	if (param <= RS274NGC_LOCAL_VARS)
+	{
+		return o_code_stack_context_index;
+	}
+#endif
+	return 0;
+}
+
+static float parser_sparse_param_get(uint16_t param, uint8_t scope)
+{
+	for (;;)
+	{
+		int16_t i = parser_sparse_param_find(param, scope);
+		if (i >= 0)
+		{
+			return parser_sparse_params[i].value;
+		}
+		if (!scope)
+		{
+			return 0;
+		}
+		scope--;
+	}
+}
+
+// checks if assigning the value would add a new entry to the table
+static bool parser_sparse_param_is_new(uint16_t param, float value)
+{
+	if (!param || param > RS274NGC_MAX_USER_VARS)
+	{
+		return false;
+	}
+
+	uint8_t scope = parser_sparse_param_scope(param);
+	if (parser_sparse_param_find(param, scope) >= 0)
+	{
+		return false;
+	}
+
+	return (value != ((scope) ? parser_sparse_param_get(param, scope - 1) : 0));
+}
+
+static bool parser_sparse_param_set(uint16_t param, float value)
+{
+	uint8_t scope = parser_sparse_param_scope(param);
+	int16_t i = parser_sparse_param_find(param, scope);
+	float inherited = (scope) ? parser_sparse_param_get(param, scope - 1) : 0;
+
+	// same as the inherited value. No need to store it
+	if (value == inherited)
+	{
+		if (i >= 0)
+		{
+			parser_sparse_param_remove(i);
+		}
+		return true;
+	}
+
+	if (i < 0)
+	{
+		if (parser_sparse_params_count >= RS274NGC_SPARSE_PARAMS_SIZE)
+		{
+			return false;
+		}
+		i = parser_sparse_param_hash(param, scope);
+		while (parser_sparse_params[i].id)
+		{
+			i = (i + 1) & SPARSE_PARAMS_MASK;
+		}
+		parser_sparse_params[i].id = param;
+		parser_sparse_params[i].scope = scope;
+		parser_sparse_params_count++;
+	}
+
+	parser_sparse_params[i].value = value;
+	return true;
+}
+
+// discards all local parameters above the given scope
+void parser_release_parameters_scope(uint8_t scope)
+{
+	for (uint16_t i = 0; i < RS274NGC_SPARSE_PARAMS_SIZE; i++)
+	{
+		while (parser_sparse_params[i].id && parser_sparse_params[i].scope > scope)
+		{
+			parser_sparse_param_remove(i);
+		}
+	}
+}
+#endif
 
 #ifdef ENABLE_NAMED_PARAMETERS
 static float parser_get_named_parameter(int param, int offset, uint8_t pos)
@@ -3537,8 +3993,19 @@ float parser_get_parameter(uint16_t param)
 
 	if (param > 0 && param <= RS274NGC_MAX_USER_VARS)
 	{
+#ifndef ENABLE_RS274NGC_SPARSE_PARAMETERS
 		return g_parser_num_params[param - 1];
+#else
+		return parser_sparse_param_get(param, parser_sparse_param_scope(param));
+#endif
+	}
+
+#ifdef ENABLE_NAMED_PARAMETERS
+	if (RS274NGC_IS_USER_NAMED_PARAM(param))
+	{
+		return parser_get_user_namedparam(param);
 	}
+#endif
 
 	switch (offset)
 	{
@@ -3633,12 +4100,25 @@ float parser_get_parameter(uint16_t param)
 	return 0;
 }
 
-void parser_set_parameter(uint16_t param, float value)
+bool parser_set_parameter(uint16_t param, float value)
 {
 	if (param > 0 && param <= RS274NGC_MAX_USER_VARS)
 	{
+#ifndef ENABLE_RS274NGC_SPARSE_PARAMETERS
 		g_parser_num_params[param - 1] = value;
+#else
+		return parser_sparse_param_set(param, value);
+#endif
+	}
+
+#ifdef ENABLE_NAMED_PARAMETERS
+	if (RS274NGC_IS_USER_NAMED_PARAM(param))
+	{
+		parser_set_user_namedparam(param, value);
 	}
+#endif
+
+	return true;
 }
 
 #endif
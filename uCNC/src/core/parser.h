@@ -39,6 +39,10 @@ extern "C"
 #define G1 1
 #define G2 2
 #define G3 3
+#ifdef ENABLE_G5_SPLINES
+// G5 and G5.1 (mantissa must also be checked)
+#define G5 5
+#endif
 #ifdef ENABLE_G39_H_MAPPING
 #define G39 39
 #endif
@@ -141,6 +145,9 @@ extern "C"
 #define GCODE_GROUP_ENABLEOVER 0x4000
 #define GCODE_GROUP_NONMODAL 0x8000
 
+// size of the modal groups array filled by parser_get_modes
+#define MAX_MODAL_GROUPS 14
+
 // word masks
 #define GCODE_WORD_X 0x0001
 #define GCODE_WORD_Y 0x0002
@@ -191,9 +198,39 @@ extern "C"
 #define EMBROIDERY_MODE 16				 // Enables Embroidery mode
 
 #ifdef ENABLE_RS274NGC_EXPRESSIONS
+#ifdef ENABLE_RS274NGC_SPARSE_PARAMETERS
+// numbered parameters are stored in a fixed size hash table
+// only parameters that are set (non zero) use RAM
+#ifndef RS274NGC_MAX_USER_VARS
+#define RS274NGC_MAX_USER_VARS 5000
+#endif
+#ifndef RS274NGC_SPARSE_PARAMS_SIZE
+#define RS274NGC_SPARSE_PARAMS_SIZE 64
+#endif
+#if ((RS274NGC_SPARSE_PARAMS_SIZE & (RS274NGC_SPARSE_PARAMS_SIZE - 1)) || RS274NGC_SPARSE_PARAMS_SIZE > 1024)
+#error "RS274NGC_SPARSE_PARAMS_SIZE must be a power of 2 and not exceed 1024"
+#endif
+#endif
 #ifndef RS274NGC_MAX_USER_VARS
 #define RS274NGC_MAX_USER_VARS 30
 #endif
+// parameters #1 to #30 are local to each subrotine call
+#define RS274NGC_LOCAL_VARS MIN(RS274NGC_MAX_USER_VARS, 30)
+#ifdef ENABLE_NAMED_PARAMETERS
+// number of user named parameters (#<name>) that can be defined
+#ifndef RS274NGC_USER_NAMED_PARAMS
+#define RS274NGC_USER_NAMED_PARAMS 16
+#endif
+#if ((RS274NGC_USER_NAMED_PARAMS & (RS274NGC_USER_NAMED_PARAMS - 1)) || RS274NGC_USER_NAMED_PARAMS > 128)
+#error "RS274NGC_USER_NAMED_PARAMS must be a power of 2 and not exceed 128"
+#endif
+// user named parameters are mapped to this id range
+#define RS274NGC_USER_NAMED_PARAMS_OFFSET 7000
+#if (RS274NGC_MAX_USER_VARS >= RS274NGC_USER_NAMED_PARAMS_OFFSET)
+#error "RS274NGC_MAX_USER_VARS must be below 7000 (the user named parameters id range)"
+#endif
+#define RS274NGC_IS_USER_NAMED_PARAM(param) ((param) >= RS274NGC_USER_NAMED_PARAMS_OFFSET && (param) < (RS274NGC_USER_NAMED_PARAMS_OFFSET + RS274NGC_USER_NAMED_PARAMS))
+#endif
 #ifndef MAX_PARSER_STACK_DEPTH
 #define MAX_PARSER_STACK_DEPTH 16
 #endif
@@ -334,13 +371,18 @@ extern "C"
 	void parser_coordinate_system_save(uint8_t param, float *target);
 #ifdef ENABLE_RS274NGC_EXPRESSIONS
 	float parser_get_parameter(uint16_t param);
-	void parser_set_parameter(uint16_t param, float value);
+	bool parser_set_parameter(uint16_t param, float value);
+#ifdef ENABLE_RS274NGC_SPARSE_PARAMETERS
+	void parser_release_parameters_scope(uint8_t scope);
+#endif
 #ifdef ENABLE_O_CODES
 	uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_explicit_t *cmd);
 	bool o_code_end_subrotine(void);
 #endif
 #ifdef ENABLE_NAMED_PARAMETERS
-	uint8_t parser_get_namedparam_id(float *value);
+	uint8_t parser_get_namedparam_id(float *value, bool allocate);
+	float parser_get_user_namedparam(uint16_t param);
+	void parser_set_user_namedparam(uint16_t param, float value);
 #endif
 #endif
 
@@ -383,6 +425,19 @@ extern "C"
 	// event_parse_token_handler
 	DECL_EVENT_HANDLER(parse_token);
 
+#ifdef ENABLE_PARSER_TOKEN_EVENTS
+	typedef struct parser_token_args_
+	{
+		uint8_t *word;
+		float *value;
+	} parser_token_args_t;
+	// event_parse_token_fetch_handler
+	DECL_EVENT_HANDLER(parse_token_fetch);
+
+	// event_parse_token_lexed_handler
+	DECL_EVENT_HANDLER(parse_token_lexed);
+#endif
+
 	// event_parser_get_modes_handler
 	DECL_EVENT_HANDLER(parser_get_modes);
 
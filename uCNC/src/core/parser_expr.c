@@ -41,7 +41,9 @@
  */
 #ifdef ENABLE_RS274NGC_EXPRESSIONS
 char parser_backtrack;
+#ifndef ENABLE_RS274NGC_SPARSE_PARAMETERS
 extern float g_parser_num_params[RS274NGC_MAX_USER_VARS];
+#endif
 #define STRLEN(s) (sizeof(s) / sizeof(s[0]))
 #define STRCMP(sram, srom) rom_strcmp(sram, __romstr__(srom))
 #ifdef ENABLE_NAMED_PARAMETERS
@@ -110,63 +112,76 @@ DECL_NAMED_PARAM(_value_returned);
 DECL_NAMED_PARAM(_task);
 DECL_NAMED_PARAM(_call_level);
 DECL_NAMED_PARAM(_remap_level);
+// this table must be kept sorted by name (binary search)
 static const named_param_t named_params[] __rom__ = {
-		NAMED_PARAM(_vmajor, 6001),
-		NAMED_PARAM(_vminor, 6002),
-		NAMED_PARAM(_line, 6003),
-		NAMED_PARAM(_motion_mode, 6010),
-		NAMED_PARAM(_plane, 6011),
+		NAMED_PARAM(_a, 5423),
+		NAMED_PARAM(_abs_a, 6053),
+		NAMED_PARAM(_abs_b, 6054),
+		NAMED_PARAM(_abs_c, 6055),
+		NAMED_PARAM(_abs_x, 6050),
+		NAMED_PARAM(_abs_y, 6051),
+		NAMED_PARAM(_abs_z, 6052),
+		NAMED_PARAM(_absolute, 6015),
+		NAMED_PARAM(_adaptive_feed, 6042),
+		NAMED_PARAM(_b, 5424),
+		NAMED_PARAM(_c, 5425),
+		NAMED_PARAM(_call_level, 6111),
 		NAMED_PARAM(_ccomp, 6012),
-		NAMED_PARAM(_metric, 6013),
+		NAMED_PARAM(_coord_system, 6020),
+		NAMED_PARAM(_current_pocket, 6060),
+		NAMED_PARAM(_current_tool, 5400),
+		NAMED_PARAM(_feed, 6044),
+		NAMED_PARAM(_feed_hold, 6043),
+		NAMED_PARAM(_feed_override, 6041),
+		NAMED_PARAM(_flood, 6033),
+		NAMED_PARAM(_ijk_absolute_mode, 6026),
 		NAMED_PARAM(_imperial, 6014),
-		NAMED_PARAM(_absolute, 6015),
 		NAMED_PARAM(_incremental, 6016),
 		NAMED_PARAM(_inverse_time, 6017),
-		NAMED_PARAM(_units_per_minute, 6018),
-		NAMED_PARAM(_units_per_rev, 6019),
-		NAMED_PARAM(_coord_system, 6020),
-		NAMED_PARAM(_tool_offset, 6021),
-		NAMED_PARAM(_retract_r_plane, 6022),
-		NAMED_PARAM(_retract_old_z, 6023),
-		NAMED_PARAM(_spindle_rpm_mode, 6024),
-		NAMED_PARAM(_spindle_css_mode, 6025),
-		NAMED_PARAM(_ijk_absolute_mode, 6026),
 		NAMED_PARAM(_lathe_diameter_mode, 6027),
 		NAMED_PARAM(_lathe_radius_mode, 6028),
-		NAMED_PARAM(_spindle_on, 6030),
-		NAMED_PARAM(_spindle_cw, 6031),
+		NAMED_PARAM(_line, 6003),
+		NAMED_PARAM(_metric, 6013),
 		NAMED_PARAM(_mist, 6032),
-		NAMED_PARAM(_flood, 6033),
-		NAMED_PARAM(_speed_override, 6040),
-		NAMED_PARAM(_feed_override, 6041),
-		NAMED_PARAM(_adaptive_feed, 6042),
-		NAMED_PARAM(_feed_hold, 6043),
-		NAMED_PARAM(_feed, 6044),
+		NAMED_PARAM(_motion_mode, 6010),
+		NAMED_PARAM(_plane, 6011),
+		NAMED_PARAM(_remap_level, 6112),
+		NAMED_PARAM(_retract_old_z, 6023),
+		NAMED_PARAM(_retract_r_plane, 6022),
 		NAMED_PARAM(_rpm, 6045),
-		NAMED_PARAM(_x, 5420),
-		NAMED_PARAM(_y, 5421),
-		NAMED_PARAM(_z, 5422),
-		NAMED_PARAM(_a, 5423),
-		NAMED_PARAM(_b, 5424),
-		NAMED_PARAM(_c, 5425),
+		NAMED_PARAM(_selected_pocket, 6062),
+		NAMED_PARAM(_selected_tool, 6061),
+		NAMED_PARAM(_speed_override, 6040),
+		NAMED_PARAM(_spindle_css_mode, 6025),
+		NAMED_PARAM(_spindle_cw, 6031),
+		NAMED_PARAM(_spindle_on, 6030),
+		NAMED_PARAM(_spindle_rpm_mode, 6024),
+		NAMED_PARAM(_task, 6110),
+		NAMED_PARAM(_tool_offset, 6021),
 		NAMED_PARAM(_u, 5426),
+		NAMED_PARAM(_units_per_minute, 6018),
+		NAMED_PARAM(_units_per_rev, 6019),
 		NAMED_PARAM(_v, 5427),
-		NAMED_PARAM(_w, 5428),
-		NAMED_PARAM(_abs_x, 6050),
-		NAMED_PARAM(_abs_y, 6051),
-		NAMED_PARAM(_abs_z, 6052),
-		NAMED_PARAM(_abs_a, 6053),
-		NAMED_PARAM(_abs_b, 6054),
-		NAMED_PARAM(_abs_c, 6055),
-		NAMED_PARAM(_current_tool, 5400),
-		NAMED_PARAM(_current_pocket, 6060),
-		NAMED_PARAM(_selected_tool, 6061),
-		NAMED_PARAM(_selected_pocket, 6062),
 		NAMED_PARAM(_value, 6100),
 		NAMED_PARAM(_value_returned, 6101),
-		NAMED_PARAM(_task, 6110),
-		NAMED_PARAM(_call_level, 6111),
-		NAMED_PARAM(_remap_level, 6112)};
+		NAMED_PARAM(_vmajor, 6001),
+		NAMED_PARAM(_vminor, 6002),
+		NAMED_PARAM(_w, 5428),
+		NAMED_PARAM(_x, 5420),
+		NAMED_PARAM(_y, 5421),
+		NAMED_PARAM(_z, 5422)};
+#define NAMED_PARAMS_COUNT (sizeof(named_params) / sizeof(named_param_t))
+
+// user named parameters are stored in a small hash table (open addressing)
+// each user named parameter is mapped to the id RS274NGC_USER_NAMED_PARAMS_OFFSET + table slot
+#define USER_NAMED_PARAMS_MASK (RS274NGC_USER_NAMED_PARAMS - 1)
+typedef struct user_named_param_
+{
+	uint16_t hash;
+	char name[NAMED_PARAM_MAX_LEN];
+	float value;
+} user_named_param_t;
+static user_named_param_t user_named_params[RS274NGC_USER_NAMED_PARAMS];
 #endif
 #ifdef ENABLE_O_CODES
 #include "../modules/file_system.h"
@@ -176,7 +191,7 @@ static const named_param_t named_params[] __rom__ = {
 #ifndef OCODE_CONTEXT_STACK_DEPTH
 #define OCODE_CONTEXT_STACK_DEPTH 10
 #endif
-#define OCODE_CONTEXT_SIZE (sizeof(float) * MIN(RS274NGC_MAX_USER_VARS, 30))
+#define OCODE_CONTEXT_SIZE (sizeof(float) * RS274NGC_LOCAL_VARS)
 #ifndef OCODE_DRIVE
 #define OCODE_DRIVE 'C'
 #endif
@@ -210,6 +225,49 @@ static const named_param_t named_params[] __rom__ = {
 static fs_file_t *o_code_file;
 static uint32_t o_code_file_pos;
 static bool o_code_file_changed;
+
+/**
+ * O-code file index
+ * Each subrotine file is scanned once when opened and the position of every O word label (sub, endsub, if, else, while, etc...)
+ * is stored in the index. Conditional discards jump directly to the next matching label instead of reading the file line by line.
+ * The file handle is kept open alongside the index so that returning to a caller file is a single seek.
+ * The index is rebuilt if the file size or timestamp changes.
+ */
+#ifndef OCODE_INDEX_SIZE
+#define OCODE_INDEX_SIZE 32
+#endif
+#ifndef OCODE_INDEX_FILES
+#define OCODE_INDEX_FILES 2
+#endif
+
+#if (OCODE_INDEX_SIZE < 1 || OCODE_INDEX_SIZE > 255)
+#error "OCODE_INDEX_SIZE must be between 1 and 255"
+#endif
+#if (OCODE_INDEX_FILES < 1)
+#error "OCODE_INDEX_FILES must be at least 1"
+#endif
+
+typedef struct o_code_label_
+{
+	uint16_t code;
+	uint32_t pos;
+} o_code_label_t;
+
+typedef struct o_code_index_
+{
+	fs_file_t *file;
+	uint32_t size;
+	uint32_t timestamp;
+	uint16_t code;
+	uint8_t age;
+	uint8_t count;
+	bool indexed;
+	bool complete;
+	o_code_label_t labels[OCODE_INDEX_SIZE];
+} o_code_index_t;
+
+static o_code_index_t o_code_index[OCODE_INDEX_FILES];
+static o_code_index_t *o_code_current_index;
 bool o_code_returned;
 float o_code_return_value;
 
@@ -225,7 +283,9 @@ typedef struct o_code_stack_
 static o_code_stack_t o_code_stack[OCODE_PARSER_STACK_DEPTH];
 uint8_t o_code_stack_index;
 uint8_t o_code_stack_context_index;
-float o_code_stack_context_vars[OCODE_CONTEXT_STACK_DEPTH][MIN(RS274NGC_MAX_USER_VARS, 30)];
+#ifndef ENABLE_RS274NGC_SPARSE_PARAMETERS
+float o_code_stack_context_vars[OCODE_CONTEXT_STACK_DEPTH][RS274NGC_LOCAL_VARS];
+#endif
 #define O_CODE_FILE_CLOSE 1
 #define O_CODE_FILE_CLOSE_ALL 2
 #endif
@@ -721,7 +781,7 @@ uint8_t parser_get_float(float *value)
 			break;
 #ifdef ENABLE_NAMED_PARAMETERS
 		case OP_NAMED_PARAM:
-			result = parser_get_namedparam_id(&rhs);
+			result = parser_get_namedparam_id(&rhs, false);
 			break;
 #endif
 		case OP_REAL:
@@ -820,24 +880,219 @@ static uint8_t o_code_file_flush(void)
 
 DECL_GRBL_STREAM(o_code_stream, o_code_getc, NULL, NULL, NULL, NULL);
 
-static void o_code_open(uint8_t index)
+#define O_CODE_INDEX_LINE_START 0
+#define O_CODE_INDEX_COMMENT 1
+#define O_CODE_INDEX_LABEL 2
+#define O_CODE_INDEX_SKIP 3
+#define O_CODE_INDEX_LINE_NUMBER 4
+
+static void o_code_index_build(o_code_index_t *index)
 {
-	if (o_code_stack[index].op == O_CODE_OP_CALL || o_code_stack[index].op == O_CODE_OP_SUB)
+	fs_file_t *fp = index->file;
+	uint8_t buffer[32];
+	uint32_t pos = 0;
+	uint32_t label_pos = 0;
+	uint16_t code = 0;
+	uint8_t state = O_CODE_INDEX_LINE_START;
+	bool has_digits = false;
+
+	index->size = fp->file_info.size;
+	index->timestamp = fp->file_info.timestamp;
+	index->count = 0;
+	index->complete = true;
+	index->indexed = true;
+
+	fs_seek(fp, 0);
+	for (;;)
 	{
-		if (o_code_file)
+		size_t len = fs_read(fp, buffer, sizeof(buffer));
+		if (!len)
 		{
-			fs_close(o_code_file);
-			o_code_file = NULL;
+			break;
 		}
 
+		for (size_t i = 0; i < len; i++, pos++)
+		{
+			uint8_t c = buffer[i];
+			bool eol = (c == '\n' || c == '\r' || c == 0);
+
+			switch (state)
+			{
+			case O_CODE_INDEX_LINE_NUMBER:
+				if ((c >= '0' && c <= '9') || c == ' ' || c == '\t')
+				{
+					continue;
+				}
+				// the N word ended
+				// the next word can still be an O label
+				state = O_CODE_INDEX_LINE_START;
+				__FALL_THROUGH__
+			case O_CODE_INDEX_LINE_START:
+				switch (c)
+				{
+				case ' ':
+				case '\t':
+					break;
+				case '(':
+					state = O_CODE_INDEX_COMMENT;
+					break;
+				case 'N':
+				case 'n':
+					state = O_CODE_INDEX_LINE_NUMBER;
+					break;
+				case 'O':
+				case 'o':
+					state = O_CODE_INDEX_LABEL;
+					label_pos = pos;
+					code = 0;
+					has_digits = false;
+					break;
+				default:
+					state = (!eol) ? O_CODE_INDEX_SKIP : O_CODE_INDEX_LINE_START;
+					break;
+				}
+				continue;
+			case O_CODE_INDEX_COMMENT:
+				if (c == ')' || eol)
+				{
+					state = O_CODE_INDEX_LINE_START;
+				}
+				continue;
+			case O_CODE_INDEX_LABEL:
+				if (c >= '0' && c <= '9')
+				{
+					code = code * 10 + (c - '0');
+					has_digits = true;
+					continue;
+				}
+				if (!has_digits && (c == ' ' || c == '\t'))
+				{
+					continue;
+				}
+				if (has_digits)
+				{
+					if (index->count == OCODE_INDEX_SIZE)
+					{
+						// the index is full
+						// everything beyond the last label will be searched line by line
+						index->complete = false;
+						return;
+					}
+					index->labels[index->count].code = code;
+					index->labels[index->count].pos = label_pos;
+					index->count++;
+				}
+				break;
+			}
+
+			state = (!eol) ? O_CODE_INDEX_SKIP : O_CODE_INDEX_LINE_START;
+		}
+	}
+}
+
+// gets the subrotine file and index from the cache or opens it
+static o_code_index_t *o_code_index_open(uint16_t code)
+{
+	o_code_index_t *index = &o_code_index[0];
+	for (uint8_t i = 0; i < OCODE_INDEX_FILES; i++)
+	{
+		if (o_code_index[i].indexed && o_code_index[i].code == code)
+		{
+			index = &o_code_index[i];
+			break;
+		}
+		// least recently used
+		if (o_code_index[i].age > index->age)
+		{
+			index = &o_code_index[i];
+		}
+	}
+
+	for (uint8_t i = 0; i < OCODE_INDEX_FILES; i++)
+	{
+		if (o_code_index[i].age < UINT8_MAX)
+		{
+			o_code_index[i].age++;
+		}
+	}
+	index->age = 0;
+
+	if (index->code != code && index->file)
+	{
+		fs_close(index->file);
+		index->file = NULL;
+	}
+
+	if (!index->file)
+	{
 		char o_subrotine[32];
 		memset(o_subrotine, 0, sizeof(o_subrotine));
-		str_sprintf(o_subrotine, "/%c/o%d.nc", OCODE_DRIVE, o_code_stack[index].code);
-		o_code_file = fs_open(o_subrotine, "r");
-		if (!o_code_file)
+		str_sprintf(o_subrotine, "/%c/o%d.nc", OCODE_DRIVE, code);
+		index->file = fs_open(o_subrotine, "r");
+		if (!index->file)
+		{
+			index->indexed = false;
+			return NULL;
+		}
+
+		if (index->code != code || index->size != index->file->file_info.size || index->timestamp != index->file->file_info.timestamp)
+		{
+			index->indexed = false;
+		}
+	}
+
+	index->code = code;
+	if (!index->indexed)
+	{
+		o_code_index_build(index);
+	}
+
+	return index;
+}
+
+// drops the cached file if it was modified
+static void o_code_index_validate(uint16_t code, fs_file_info_t *finfo)
+{
+	for (uint8_t i = 0; i < OCODE_INDEX_FILES; i++)
+	{
+		o_code_index_t *index = &o_code_index[i];
+		if (index->indexed && index->code == code && (index->size != finfo->size || index->timestamp != finfo->timestamp))
+		{
+			if (index->file)
+			{
+				fs_close(index->file);
+				index->file = NULL;
+			}
+			index->indexed = false;
+		}
+	}
+}
+
+static void o_code_index_close_all(void)
+{
+	for (uint8_t i = 0; i < OCODE_INDEX_FILES; i++)
+	{
+		if (o_code_index[i].file)
+		{
+			fs_close(o_code_index[i].file);
+			o_code_index[i].file = NULL;
+		}
+	}
+	o_code_file = NULL;
+	o_code_current_index = NULL;
+}
+
+static void o_code_open(uint8_t index)
+{
+	if (o_code_stack[index].op == O_CODE_OP_CALL || o_code_stack[index].op == O_CODE_OP_SUB)
+	{
+		o_code_current_index = o_code_index_open(o_code_stack[index].code);
+		if (!o_code_current_index)
 		{
+			o_code_file = NULL;
 			return;
 		}
+		o_code_file = o_code_current_index->file;
 		o_code_stack[index].op = O_CODE_OP_SUB;
 		// reload file and rewind stack
 		fs_seek(o_code_file, o_code_file_pos);
@@ -866,15 +1121,11 @@ static uint8_t o_code_entry_point(uint8_t index)
 
 static uint8_t o_code_close(uint8_t index)
 {
-	// close file
+	// release file (it's kept open in the index cache)
 	if (index)
 	{
-		if (o_code_file)
-		{
-			fs_close(o_code_file);
-			o_code_file = NULL;
-		}
-
+		o_code_file = NULL;
+		o_code_current_index = NULL;
 		index = o_code_entry_point(index);
 	}
 
@@ -888,8 +1139,12 @@ bool o_code_end_subrotine(void)
 	{
 		index = o_code_close(index);
 		// restore user vars
-		memcpy(g_parser_num_params, o_code_stack_context_vars[o_code_stack[index].context_index], OCODE_CONTEXT_SIZE);
 		o_code_stack_context_index = o_code_stack[index].context_index;
+#ifndef ENABLE_RS274NGC_SPARSE_PARAMETERS
+		memcpy(g_parser_num_params, o_code_stack_context_vars[o_code_stack_context_index], OCODE_CONTEXT_SIZE);
+#else
+		parser_release_parameters_scope(o_code_stack_context_index);
+#endif
 
 		// restore file pointer and mark entry for (re)call
 		o_code_file_pos = o_code_stack[index].pos;
@@ -907,14 +1162,13 @@ bool o_code_end_subrotine(void)
 	}
 
 	// clear and close all
-	if (o_code_file)
-	{
-		fs_close(o_code_file);
-		o_code_file = NULL;
-	}
+	o_code_index_close_all();
 	memset(o_code_stack, 0, sizeof(o_code_stack));
 	o_code_stack_index = 0;
 	o_code_stack_context_index = 0;
+#ifdef ENABLE_RS274NGC_SPARSE_PARAMETERS
+	parser_release_parameters_scope(0);
+#endif
 	// grbl_stream_change(NULL);
 	grbl_stream_readonly(o_code_file_flush, NULL, NULL);
 	return false;
@@ -931,6 +1185,27 @@ static bool o_code_seek(uint32_t pos)
 	return false;
 }
 
+// jumps to the next label with the same O number using the file index
+static bool o_code_index_jump(uint16_t code)
+{
+	o_code_index_t *index = o_code_current_index;
+	if (!o_code_file || !index)
+	{
+		return false;
+	}
+
+	uint32_t pos = o_code_file->file_info.size - fs_available(o_code_file);
+	for (uint8_t i = 0; i < index->count; i++)
+	{
+		if (index->labels[i].pos >= pos && index->labels[i].code == code)
+		{
+			return o_code_seek(index->labels[i].pos + 1);
+		}
+	}
+
+	return false;
+}
+
 uint8_t o_code_validate(uint8_t op, uint16_t ocode_id, bool is_new)
 {
 	for (uint8_t index = o_code_stack_index; index != 0;)
@@ -954,12 +1229,16 @@ uint8_t o_code_validate(uint8_t op, uint16_t ocode_id, bool is_new)
 #ifdef PROCESS_COMMENTS
 extern bool g_mute_comment_output;
 #endif
-static void o_code_discard(void)
+static void o_code_discard(uint16_t code)
 {
 #ifdef PROCESS_COMMENTS
 	g_mute_comment_output = true;
 #endif
-	while (parser_get_next_preprocessed(true) != 'O')
+	if (TOUPPER(parser_get_next_preprocessed(true)) != 'O')
+	{
+		o_code_index_jump(code);
+	}
+	while (TOUPPER(parser_get_next_preprocessed(true)) != 'O')
 	{
 		parser_discard_command();
 	}
@@ -973,20 +1252,18 @@ static void FORCEINLINE o_code_word_error(uint8_t *error)
 	if (*error >= STATUS_OCODE_ERROR_MIN && *error <= STATUS_OCODE_ERROR_MAX)
 	{
 		// Error in o-code, do not continue execution and empty the stack.
-		if (o_code_file)
+		o_code_index_close_all();
+		if (o_code_stack_context_index)
 		{
-			fs_close(o_code_file);
-			o_code_file = NULL;
-		}
-		if (o_code_stack_index)
-		{
-			for (uint16_t i = 0; i < RS274NGC_MAX_USER_VARS; i++)
-			{
-				parser_set_parameter(i + 1, o_code_stack_context_vars[0][i]);
-			}
+#ifndef ENABLE_RS274NGC_SPARSE_PARAMETERS
+			memcpy(g_parser_num_params, o_code_stack_context_vars[0], OCODE_CONTEXT_SIZE);
+#else
+			parser_release_parameters_scope(0);
+#endif
 		}
 		memset(o_code_stack, 0, sizeof(o_code_stack));
 		o_code_stack_index = 0;
+		o_code_stack_context_index = 0;
 		o_code_file_pos = 0;
 		//		grbl_stream_change(NULL);
 		grbl_stream_readonly(o_code_file_flush, NULL, NULL);
@@ -1010,7 +1287,7 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 	if (index && ((o_code_stack[index - 1].op == O_CODE_OP_IF) || (o_code_stack[index - 1].op & O_CODE_OP_DISCARD)) && o_code_stack[index - 1].code != ocode_id)
 	{
 		// keep discarding
-		o_code_discard();
+		o_code_discard(o_code_stack[index - 1].code);
 		error = STATUS_OK;
 		return error;
 	}
@@ -1039,9 +1316,16 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 	if (!STRCMP(o_cmd, "CALL"))
 	{
 		DBGLOG("[EXPR] O%u CALL", ocode_id);
+		if (o_code_stack_context_index >= OCODE_CONTEXT_STACK_DEPTH)
+		{
+			error = STATUS_OCODE_ERROR_STACK_OVERFLOW;
+			return error;
+		}
 		// store user vars
 		uint8_t i_context = o_code_stack_context_index++;
+#ifndef ENABLE_RS274NGC_SPARSE_PARAMETERS
 		memcpy(&o_code_stack_context_vars[i_context], g_parser_num_params, OCODE_CONTEXT_SIZE);
+#endif
 
 		// check if file exists
 		char o_subrotine[32];
@@ -1054,13 +1338,18 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 			error = STATUS_OCODE_ERROR_INVALID_OPERATION;
 			return error;
 		}
+		o_code_index_validate(ocode_id, &finfo);
 
 		// call parameters
 		uint16_t arg_i = 0;
 		while (op_arg_error == NUMBER_OK)
 		{
 			// load args
-			g_parser_num_params[arg_i++] = op_arg;
+			if (arg_i >= RS274NGC_LOCAL_VARS || !parser_set_parameter(++arg_i, op_arg))
+			{
+				error = STATUS_OCODE_ERROR_STACK_OVERFLOW;
+				return error;
+			}
 			op_arg_error = parser_get_float(&op_arg);
 		}
 
@@ -1073,6 +1362,8 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 
 		// workaround to ftell
 		o_code_stack[index].pos = (o_code_file) ? (o_code_file->file_info.size - fs_available(o_code_file)) : 0;
+		// subrotine always starts from the beginning
+		o_code_file_pos = 0;
 		o_code_open(index);
 
 		o_code_stack_index++;
@@ -1145,7 +1436,7 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 				{
 					o_code_stack[index].op = O_CODE_OP_IF_DISCARD;
 				}
-				o_code_discard();
+				o_code_discard(ocode_id);
 			}
 			break;
 		}
@@ -1220,7 +1511,7 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 			o_code_stack[index].op = (type == 5) ? O_CODE_OP_WHILE_BREAK : O_CODE_OP_WHILE_DISCARD;
 		}
 		// start command discard
-		o_code_discard();
+		o_code_discard(ocode_id);
 		error = STATUS_OK;
 		return error;
 	}
@@ -1271,7 +1562,7 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 					{
 						// mark to exit loop
 						o_code_stack[index].op = O_CODE_OP_WHILE_BREAK;
-						o_code_discard();
+						o_code_discard(ocode_id);
 					}
 					error = STATUS_OK;
 					return error;
@@ -1345,7 +1636,7 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 				else
 				{
 					o_code_stack[index].op = O_CODE_OP_WHILE_BREAK;
-					o_code_discard();
+					o_code_discard(ocode_id);
 				}
 			}
 			else if (O_CODE_BASE_TYPE(o_code_stack[index].op) == O_CODE_OP_WHILE && ocode_id == o_code_stack[index].code)
@@ -1466,10 +1757,77 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 #endif
 
 #ifdef ENABLE_NAMED_PARAMETERS
-uint8_t parser_get_namedparam_id(float *value)
+static int8_t parser_find_builtin_namedparam(const char *name)
+{
+	uint8_t lo = 0;
+	uint8_t hi = NAMED_PARAMS_COUNT;
+	while (lo < hi)
+	{
+		uint8_t mid = (lo + hi) >> 1;
+		int cmp = rom_strcmp(name, (const char *)rom_strptr(&(named_params[mid].name)));
+		if (!cmp)
+		{
+			return mid;
+		}
+
+		if (cmp < 0)
+		{
+			hi = mid;
+		}
+		else
+		{
+			lo = mid + 1;
+		}
+	}
+
+	return -1;
+}
+
+static int16_t parser_find_user_namedparam(const char *name, uint16_t hash, bool allocate)
+{
+	uint8_t slot = hash & USER_NAMED_PARAMS_MASK;
+	for (uint16_t i = 0; i < RS274NGC_USER_NAMED_PARAMS; i++)
+	{
+		user_named_param_t *p = &user_named_params[slot];
+		if (!p->name[0])
+		{
+			if (!allocate)
+			{
+				return -1;
+			}
+			p->hash = hash;
+			p->value = 0;
+			strcpy(p->name, name);
+			return slot;
+		}
+
+		if (p->hash == hash && !strcmp(p->name, name))
+		{
+			return slot;
+		}
+
+		slot = (slot + 1) & USER_NAMED_PARAMS_MASK;
+	}
+
+	return -1;
+}
+
+float parser_get_user_namedparam(uint16_t param)
+{
+	return user_named_params[(param - RS274NGC_USER_NAMED_PARAMS_OFFSET) & USER_NAMED_PARAMS_MASK].value;
+}
+
+void parser_set_user_namedparam(uint16_t param, float value)
+{
+	user_named_params[(param - RS274NGC_USER_NAMED_PARAMS_OFFSET) & USER_NAMED_PARAMS_MASK].value = value;
+}
+
+uint8_t parser_get_namedparam_id(float *value, bool allocate)
 {
 	char namedparam[NAMED_PARAM_MAX_LEN];
 	bool valid = false;
+	// 16 bit xor-multiply hash computed while the name is read
+	uint16_t hash = 0x811C;
 	unsigned char c = parser_get_next_preprocessed(true);
 	c = TOUPPER(c);
 	if (c == '<')
@@ -1486,23 +1844,30 @@ uint8_t parser_get_namedparam_id(float *value)
 			{
 				parser_get_next_preprocessed(false);
 				namedparam[i] = 0;
-				valid = true;
+				valid = (i != 0);
 				break;
 			}
-			namedparam[i] = parser_get_next_preprocessed(false);
+			c = parser_get_next_preprocessed(false);
+			namedparam[i] = c;
+			hash = (hash ^ c) * 0x0193;
 		}
 
 		if (valid)
 		{
-			for (uint8_t i = 0; i < sizeof(named_params) / sizeof(named_param_t); i++)
+			int16_t i = parser_find_builtin_namedparam(namedparam);
+			if (i >= 0)
 			{
-				if (!rom_strcmp(namedparam, (const char *)rom_strptr(&(named_params[i].name))))
-				{
-					named_param_t p = {0};
-					rom_memcpy(&p, &named_params[i], sizeof(named_param_t));
-					*value = (float)p.id;
-					return NUMBER_OK;
-				}
+				named_param_t p = {0};
+				rom_memcpy(&p, &named_params[i], sizeof(named_param_t));
+				*value = (float)p.id;
+				return NUMBER_OK;
+			}
+
+			i = parser_find_user_namedparam(namedparam, hash, allocate);
+			if (i >= 0)
+			{
+				*value = (float)(RS274NGC_USER_NAMED_PARAMS_OFFSET + i);
+				return NUMBER_OK;
 			}
 		}
 	}
@@ -84,6 +84,9 @@ void planner_add_line(motion_data_t *block_data)
 #endif
 #ifdef GCODE_PROCESS_LINE_NUMBERS
 	planner_data[index].line = block_data->line;
+#ifdef ENABLE_FS_JOB_JOURNAL
+	planner_data[index].file_line = block_data->file_line;
+#endif
 
 #endif
 
@@ -33,7 +33,7 @@ extern "C"
 #define PLANNER_BUFFER_SIZE 20
 #endif
 
-#define PLANNER_MOTION_EXACT_PATH 32 // default (not used)
+#define PLANNER_MOTION_EXACT_PATH 0 // default (not used)
 #define PLANNER_MOTION_EXACT_STOP 64
 #define PLANNER_MOTION_CONTINUOUS 128
 
@@ -44,6 +44,9 @@ extern "C"
 	{
 #ifdef GCODE_PROCESS_LINE_NUMBERS
 		uint32_t line;
+#ifdef ENABLE_FS_JOB_JOURNAL
+		uint32_t file_line;
+#endif
 #endif
 		uint8_t dirbits;
 		step_t steps[STEPPER_COUNT];
@@ -797,7 +797,7 @@ extern "C"
 #endif
 	}
 
-	void mcu_wifi_init(void)
+	static void mcu_flash_fs_init(void)
 	{
 		if (FLASH_FS.begin())
 		{
@@ -818,11 +818,24 @@ extern "C"
 				.next = NULL};
 			fs_mount(&flash_fs);
 		}
+	}
+
+#ifndef ENABLE_FAST_BOOT
+	void mcu_wifi_init(void)
+#else
+	static bool mcu_wifi_deferred_init(void *args)
+#endif
+	{
+#if (!defined(ENABLE_FAST_BOOT) || !defined(ENABLE_NVM_JOURNAL))
+		mcu_flash_fs_init();
+#endif
 
 #ifdef ENABLE_WIFI
 		ota_server_start();
 
+#ifndef ENABLE_FAST_BOOT
 		wifi_settings_offset = settings_register_external_setting(sizeof(wifi_settings_t));
+#endif
 		if (settings_load(wifi_settings_offset, (uint8_t *)&wifi_settings, sizeof(wifi_settings_t)))
 		{
 			wifi_settings = {0};
@@ -836,8 +849,29 @@ extern "C"
 
 #ifdef BOARD_HAS_CUSTOM_SYSTEM_COMMANDS
 		ADD_EVENT_LISTENER(grbl_cmd, mcu_custom_grbl_cmd);
+#endif
+#ifdef ENABLE_FAST_BOOT
+		return EVENT_HANDLED;
 #endif
 	}
+
+#ifdef ENABLE_FAST_BOOT
+	CREATE_EVENT_LISTENER(cnc_deferred_init, mcu_wifi_deferred_init);
+
+	void mcu_wifi_init(void)
+	{
+#ifdef ENABLE_WIFI
+		// the settings are registered now to keep the same settings layout
+		wifi_settings_offset = settings_register_external_setting(sizeof(wifi_settings_t));
+#endif
+#ifdef ENABLE_NVM_JOURNAL
+		// the settings journal must be available before the settings are loaded
+		mcu_flash_fs_init();
+#endif
+		// the flash file system and WiFi are started after startup from the main loop
+		ADD_EVENT_LISTENER(cnc_deferred_init, mcu_wifi_deferred_init);
+	}
+#endif
 }
 
 #endif
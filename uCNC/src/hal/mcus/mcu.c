@@ -95,6 +95,7 @@ void mcu_telnet_clear(void)
 #define GRBL_TELNET_TIMEOUT 2000
 #endif
 
+#ifndef ENABLE_STREAM_TX_QUEUE
 void mcu_telnet_flush(void)
 {
 	// if no clients just throws away the buffer
@@ -113,7 +114,308 @@ void mcu_telnet_flush(void)
 		telnet_broadcast(&telnet_proto, (char *)tmp, r, GRBL_TELNET_TIMEOUT);
 	}
 }
+#else
+// the chunk being sent to the clients (each client might be at a different offset)
+static uint8_t telnet_tx_chunk[TELNET_TX_BUFFER_SIZE];
+static uint8_t telnet_tx_chunk_len;
+static uint8_t telnet_tx_offset[SOCKET_MAX_CLIENTS];
+static uint32_t telnet_tx_progress;
+
+uint8_t mcu_telnet_write_available(void)
+{
+	// waits for the chunk in flight to reach all clients
+	if (telnet_tx_chunk_len)
+	{
+		return 0;
+	}
+
+	return BUFFER_WRITE_AVAILABLE(telnet_tx);
+}
+
+void mcu_telnet_flush(void)
+{
+	// if no clients just throws away the buffer
+	if (!telnet_hasclients(&telnet_proto))
+	{
+		BUFFER_CLEAR(telnet_tx);
+		telnet_tx_chunk_len = 0;
+		return;
+	}
+
+	socket_if_t *socket = telnet_proto.telnet_socket;
+	if (!telnet_tx_chunk_len)
+	{
+		if (BUFFER_EMPTY(telnet_tx))
+		{
+			return;
+		}
+		BUFFER_READ(telnet_tx, telnet_tx_chunk, TELNET_TX_BUFFER_SIZE, telnet_tx_chunk_len);
+		memset(telnet_tx_offset, 0, sizeof(telnet_tx_offset));
+		telnet_tx_progress = mcu_millis();
+	}
+
+	// never waits for a client
+	bool pending = false;
+	for (uint8_t i = 0; i < SOCKET_MAX_CLIENTS; i++)
+	{
+		if (telnet_tx_offset[i] >= telnet_tx_chunk_len || !socket_client_is_connected(socket, i))
+		{
+			continue;
+		}
+
+		int sent = socket_send(socket, i, &telnet_tx_chunk[telnet_tx_offset[i]], telnet_tx_chunk_len - telnet_tx_offset[i], true);
+		if (sent < 0)
+		{
+			(void)socket_close(socket, i);
+			telnet_tx_offset[i] = telnet_tx_chunk_len;
+			continue;
+		}
+
+		if (sent > 0)
+		{
+			telnet_tx_offset[i] += (uint8_t)sent;
+			telnet_tx_progress = mcu_millis();
+		}
+
+		pending |= (telnet_tx_offset[i] < telnet_tx_chunk_len);
+	}
+
+	if (pending && (uint32_t)(mcu_millis() - telnet_tx_progress) < GRBL_TELNET_TIMEOUT)
+	{
+		return;
+	}
+
+	// clients that took nothing for too long are dropped
+	for (uint8_t i = 0; pending && i < SOCKET_MAX_CLIENTS; i++)
+	{
+		if (telnet_tx_offset[i] < telnet_tx_chunk_len && socket_client_is_connected(socket, i))
+		{
+			(void)socket_close(socket, i);
+		}
+	}
+	telnet_tx_chunk_len = 0;
+}
+#endif
+
+#endif
+
+// websocket G-code channel
+// binary messages start with a frame type byte (see WS_GCODE_* in websocket.h)
+// lines frames carry many G-code lines and may only use the credits granted by the controller
+// realtime frames are executed as soon as they arrive, even if the lines buffer is full
+// text messages are treated as a plain character stream (credit owner only)
+#if defined(ENABLE_SOCKETS) && defined(ENABLE_WEBSOCKET_GCODE)
+#ifndef WEBSOCKET_GCODE_PORT
+#define WEBSOCKET_GCODE_PORT 81
+#endif
+
+// minimum amount of freed RX buffer bytes that is worth a credit frame
+#ifndef WEBSOCKET_GCODE_CREDIT_STEP
+#define WEBSOCKET_GCODE_CREDIT_STEP (RX_BUFFER_CAPACITY >> 2)
+#endif
+
+websocket_protocol_t ws_gcode_proto;
+DECL_BUFFER(uint8_t, ws_gcode_rx, RX_BUFFER_SIZE);
+DECL_BUFFER(uint8_t, ws_gcode_tx, WEBSOCKET_GCODE_TX_BUFFER_SIZE);
+// client that owns the credits (only one sender can stream lines)
+static int8_t ws_gcode_owner;
+// credited bytes that were not received yet
+static uint16_t ws_gcode_outstanding;
+// type of the binary message being received by each client (0 means the next byte is the type)
+static uint8_t ws_gcode_frame[SOCKET_MAX_CLIENTS];
+
+static void mcu_ws_gcode_credit(bool force)
+{
+	uint8_t packet[3];
+	uint16_t free_bytes;
+	uint16_t grant;
+
+	if (ws_gcode_owner < 0)
+	{
+		return;
+	}
+
+	free_bytes = BUFFER_WRITE_AVAILABLE(ws_gcode_rx);
+	free_bytes = (free_bytes > SAFEMARGIN) ? (free_bytes - SAFEMARGIN) : 0;
+	if (free_bytes <= ws_gcode_outstanding)
+	{
+		return;
+	}
+
+	grant = free_bytes - ws_gcode_outstanding;
+	if (!force && grant < WEBSOCKET_GCODE_CREDIT_STEP && !BUFFER_EMPTY(ws_gcode_rx))
+	{
+		return;
+	}
+
+	packet[0] = WS_GCODE_CREDIT;
+	packet[1] = (uint8_t)grant;
+	packet[2] = (uint8_t)(grant >> 8);
+	if (websocket_send(&ws_gcode_proto, (uint8_t)ws_gcode_owner, packet, sizeof(packet), WS_SEND_BIN) >= 0)
+	{
+		ws_gcode_outstanding += grant;
+	}
+}
+
+static void mcu_ws_gcode_rx(uint8_t ch)
+{
+	if (mcu_com_rx_cb(ch))
+	{
+		if (!BUFFER_FULL(ws_gcode_rx))
+		{
+			BUFFER_ENQUEUE(ws_gcode_rx, &ch);
+		}
+		else
+		{
+			STREAM_OVF(ch); // Optional overflow handler
+		}
+	}
+}
+
+static void mcu_ws_gcode_reject(uint8_t client_idx)
+{
+	uint8_t code[2] = {0x03, 0xF0}; // 1008 policy violation
+	websocket_send(&ws_gcode_proto, client_idx, code, sizeof(code), WS_SEND_CLOSE);
+}
+
+void mcu_ws_gcode_onrecv(uint8_t client_idx, const void *data, size_t data_len, uint8_t flags)
+{
+	const uint8_t *buffer = (const uint8_t *)data;
+
+	if (client_idx >= SOCKET_MAX_CLIENTS)
+	{
+		return;
+	}
+
+	// only the credit owner can stream lines (text messages are also lines)
+	if ((flags & WS_OPCODE_TEXT) && client_idx != ws_gcode_owner)
+	{
+		mcu_ws_gcode_reject(client_idx);
+		return;
+	}
+
+	for (size_t i = 0; i < data_len; i++)
+	{
+		uint8_t ch = buffer[i];
+		if (flags & WS_OPCODE_TEXT)
+		{
+			mcu_ws_gcode_rx(ch);
+			continue;
+		}
 
+		switch (ws_gcode_frame[client_idx])
+		{
+		case 0:
+			ws_gcode_frame[client_idx] = ch;
+			if (ch == WS_GCODE_LINES && client_idx != ws_gcode_owner)
+			{
+				mcu_ws_gcode_reject(client_idx);
+				return;
+			}
+			break;
+		case WS_GCODE_LINES:
+			if (ws_gcode_outstanding)
+			{
+				ws_gcode_outstanding--;
+			}
+			mcu_ws_gcode_rx(ch);
+			break;
+		case WS_GCODE_REALTIME:
+			// only realtime commands are accepted
+			mcu_com_rx_cb(ch);
+			break;
+		default:
+			// unknown frames are discarded
+			break;
+		}
+	}
+
+	if (flags & WS_OPCODE_FRAGMENT_FIN)
+	{
+		ws_gcode_frame[client_idx] = 0;
+	}
+}
+
+static void mcu_ws_gcode_onopen(uint8_t client_idx)
+{
+	if (client_idx >= SOCKET_MAX_CLIENTS)
+	{
+		return;
+	}
+	ws_gcode_frame[client_idx] = 0;
+	if (ws_gcode_owner < 0)
+	{
+		ws_gcode_owner = (int8_t)client_idx;
+		ws_gcode_outstanding = 0;
+		mcu_ws_gcode_credit(true);
+	}
+}
+
+static void mcu_ws_gcode_onclose(uint8_t client_idx, uint16_t code)
+{
+	(void)code;
+	if (ws_gcode_owner == (int8_t)client_idx)
+	{
+		ws_gcode_owner = -1;
+		ws_gcode_outstanding = 0;
+	}
+}
+
+uint8_t mcu_ws_gcode_available(void)
+{
+	uint8_t avail = BUFFER_READ_AVAILABLE(ws_gcode_rx);
+	if (!avail)
+	{
+		// a starving sender gets all the room back
+		mcu_ws_gcode_credit(false);
+	}
+	return avail;
+}
+
+uint8_t mcu_ws_gcode_getc(void)
+{
+	uint8_t c = 0;
+	BUFFER_DEQUEUE(ws_gcode_rx, &c);
+	return c;
+}
+
+void mcu_ws_gcode_putc(uint8_t c)
+{
+	while (BUFFER_FULL(ws_gcode_tx))
+	{
+		mcu_ws_gcode_flush();
+	}
+	BUFFER_ENQUEUE(ws_gcode_tx, &c);
+}
+
+void mcu_ws_gcode_clear(void)
+{
+	BUFFER_CLEAR(ws_gcode_tx);
+}
+
+void mcu_ws_gcode_flush(void)
+{
+	while (!BUFFER_EMPTY(ws_gcode_tx))
+	{
+		uint8_t tmp[WEBSOCKET_GCODE_TX_BUFFER_SIZE];
+		uint8_t r = 0;
+
+		BUFFER_READ(ws_gcode_tx, tmp, WEBSOCKET_GCODE_TX_BUFFER_SIZE, r);
+		websocket_send(&ws_gcode_proto, 0, tmp, r, WS_SEND_TXT | WS_SEND_BROADCAST);
+	}
+
+	mcu_ws_gcode_credit(false);
+}
+
+socket_if_t *mcu_ws_gcode_start(void)
+{
+	ws_gcode_owner = -1;
+	ws_gcode_outstanding = 0;
+	ws_gcode_proto.ws_onrecv_cb = mcu_ws_gcode_onrecv;
+	ws_gcode_proto.ws_onopen_cb = mcu_ws_gcode_onopen;
+	ws_gcode_proto.ws_onclose_cb = mcu_ws_gcode_onclose;
+	return websocket_start_listen(&ws_gcode_proto, WEBSOCKET_GCODE_PORT);
+}
 #endif
 
 // most MCU can perform some sort of loop within 4 to 6 CPU cycles + a small function call overhead
@@ -918,6 +1220,10 @@ static void FORCEINLINE mcu_coms_init(void)
 #endif
 	BUFFER_INIT(uint8_t, telnet_tx, TELNET_TX_BUFFER_SIZE);
 	BUFFER_INIT(uint8_t, telnet_rx, RX_BUFFER_SIZE);
+#ifdef ENABLE_WEBSOCKET_GCODE
+	BUFFER_INIT(uint8_t, ws_gcode_tx, WEBSOCKET_GCODE_TX_BUFFER_SIZE);
+	BUFFER_INIT(uint8_t, ws_gcode_rx, RX_BUFFER_SIZE);
+#endif
 	mcu_network_init();
 	//
 #endif
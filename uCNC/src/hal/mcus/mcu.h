@@ -630,12 +630,27 @@ extern "C"
 	void mcu_telnet_clear(void);
 	void mcu_telnet_putc(uint8_t c);
 	void mcu_telnet_flush(void);
+#ifdef ENABLE_STREAM_TX_QUEUE
+	uint8_t mcu_telnet_write_available(void);
+#endif
 #ifdef DETACH_TELNET_FROM_MAIN_PROTOCOL
 	MCU_RX_CALLBACK void mcu_telnet_rx_cb(uint8_t c);
 #endif																				  // must be called from mcu_init if the default mcu_init is overriden
 	void mcu_telnet_onrecv(uint8_t client_idx, const uint8_t *data, size_t data_len); // the callback when data is received
 #endif
 
+#if defined(ENABLE_SOCKETS) && defined(ENABLE_WEBSOCKET_GCODE)
+#include "../../modules/net/websocket.h"
+	extern websocket_protocol_t ws_gcode_proto;
+	socket_if_t *mcu_ws_gcode_start(void);
+	uint8_t mcu_ws_gcode_getc(void);
+	uint8_t mcu_ws_gcode_available(void);
+	void mcu_ws_gcode_clear(void);
+	void mcu_ws_gcode_putc(uint8_t c);
+	void mcu_ws_gcode_flush(void);
+	void mcu_ws_gcode_onrecv(uint8_t client_idx, const void *data, size_t data_len, uint8_t flags);
+#endif
+
 #ifdef MCU_HAS_BLUETOOTH
 	void mcu_bt_init(void);
 	uint8_t mcu_bt_getc(void);
@@ -626,6 +626,14 @@ extern "C"
 	extern void get_current_dir(char *cwd, size_t len);
 	extern int start_timer(int mSec, void (*timer_func_handler)(void));
 	extern void flash_fs_init(void);
+#if (defined(ENABLE_FAST_BOOT) && !defined(ENABLE_NVM_JOURNAL))
+	static bool flash_fs_deferred_init(void *args)
+	{
+		flash_fs_init();
+		return EVENT_HANDLED;
+	}
+	CREATE_EVENT_LISTENER(cnc_deferred_init, flash_fs_deferred_init);
+#endif
 
 	void mcu_init(void)
 	{
@@ -687,6 +695,10 @@ extern "C"
 #endif
 		BUFFER_INIT(uint8_t, telnet_tx, TELNET_TX_BUFFER_SIZE);
 		BUFFER_INIT(uint8_t, telnet_rx, RX_BUFFER_SIZE);
+#ifdef ENABLE_WEBSOCKET_GCODE
+		BUFFER_INIT(uint8_t, ws_gcode_tx, WEBSOCKET_GCODE_TX_BUFFER_SIZE);
+		BUFFER_INIT(uint8_t, ws_gcode_rx, RX_BUFFER_SIZE);
+#endif
 		mcu_network_init();
 #endif
 #ifdef MCU_HAS_BLUETOOTH
@@ -698,7 +710,13 @@ extern "C"
 #endif
 
 		mcu_enable_global_isr();
+		// the settings journal must be available before the settings are loaded (not deferred)
+#if (!defined(ENABLE_FAST_BOOT) || defined(ENABLE_NVM_JOURNAL))
 		flash_fs_init();
+#else
+		// mounts the file system after startup
+		ADD_EVENT_LISTENER(cnc_deferred_init, flash_fs_deferred_init);
+#endif
 		ota_server_start();
 	}
 
@@ -724,12 +742,14 @@ extern "C"
 
 	/* NVM glue to EEPROM file */
 	void mcu_io_reset(void) {}
+#ifndef ENABLE_NVM_JOURNAL
 	void nvm_start_read(uint16_t address) { (void)address; }
 	void nvm_start_write(uint16_t address) { (void)address; }
 	uint8_t nvm_getc(uint16_t address) { return mcu_eeprom_getc(address); }
 	void nvm_putc(uint16_t address, uint8_t c) { mcu_eeprom_putc(address, c); }
 	void nvm_end_read(void) {}
 	void nvm_end_write(void) { mcu_eeprom_flush(); }
+#endif
 
 /**
  * Emulate OTA page
@@ -574,8 +574,11 @@ extern "C"
     }
     bool flash_fs_remove(const char *path)
     {
+        /* paths are relative to the working dir like on open */
+        char file[256] = ".";
+        strncat(file, path, sizeof(file) - strlen(file) - 1);
         if (flash_fs.drive)
-            return remove(path) == 0;
+            return remove(file) == 0;
         return false;
     }
     bool flash_fs_mkdir(const char *path)
@@ -639,83 +642,493 @@ extern "C"
 
 #if defined(ENABLE_SOCKETS)
 
-    // typedef int socklen_t;
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <limits.h>
 
-    /* socket_init: nothing to do on Linux; return 0 on success */
-    int socket_init(void)
+#include "../../../modules/net/socket.h"
+
+#define LINUX_SOCKET_MAX_LISTENERS MAX_SOCKETS
+#define LINUX_SOCKET_MAX_CLIENTS SOCKET_MAX_CONNECTIONS
+
+#if LINUX_SOCKET_MAX_LISTENERS > 32767U
+#error "LINUX_SOCKET_MAX_LISTENERS exceeds backend handle slot capacity"
+#endif
+
+#if LINUX_SOCKET_MAX_CLIENTS > 32767U
+#error "LINUX_SOCKET_MAX_CLIENTS exceeds backend handle slot capacity"
+#endif
+
+/*
+ * epoll backend
+ *
+ * The kernel keeps the ready list so a poll pass only touches descriptors that
+ * actually have events. Idle connections cost nothing per main loop pass.
+ *
+ * Clients are armed with EPOLLONESHOT. After a readable() event the descriptor
+ * stays disarmed (the readable hint is latched in the core) until recv()
+ * observes WOULD_BLOCK and re-arms it. Remote close and errors are reported as
+ * readable so the following recv() emits closed() from the I/O path.
+ *
+ * Handles use the same generation-tagged layout as the Windows backend:
+ * the low 16 bits encode (slot << 1) | kind and the high 16 bits a non-zero
+ * generation. The epoll user data carries the handle so stale events for a
+ * reused descriptor are discarded.
+ */
+#define LINUX_HANDLE_KIND_CLIENT ((uintptr_t)1U)
+#define LINUX_HANDLE_SLOT_SHIFT 1U
+#define LINUX_HANDLE_GENERATION_SHIFT 16U
+#define LINUX_HANDLE_LOW_MASK ((uintptr_t)0xFFFFU)
+#define LINUX_HANDLE_SLOT_MASK ((uintptr_t)0x7FFFU)
+
+#define LINUX_SOCKET_MAX_EVENTS (LINUX_SOCKET_MAX_LISTENERS + LINUX_SOCKET_MAX_CLIENTS)
+#define LINUX_CLIENT_EVENTS (EPOLLIN | EPOLLRDHUP | EPOLLONESHOT)
+
+    typedef struct linux_socket_state_
     {
-        return 0;
+        int epoll_fd;
+        int listener_fds[LINUX_SOCKET_MAX_LISTENERS];
+        int client_fds[LINUX_SOCKET_MAX_CLIENTS];
+        const socket_device_events_t *events;
+        socket_device_token_t client_tokens[LINUX_SOCKET_MAX_CLIENTS];
+        uint16_t client_generations[LINUX_SOCKET_MAX_CLIENTS];
+        uint16_t listener_generations[LINUX_SOCKET_MAX_LISTENERS];
+    } linux_socket_state_t;
+
+    static linux_socket_state_t linux_state = {.epoll_fd = -1};
+
+    static uint16_t linux_next_generation(uint16_t generation)
+    {
+        ++generation;
+        if (generation == 0U)
+        {
+            ++generation;
+        }
+        return generation;
     }
 
-    /* BSD-style wrappers mapped to Linux functions */
+    static socket_device_handle_t linux_make_handle(bool client, uint16_t slot, uint16_t generation)
+    {
+        uintptr_t value = ((uintptr_t)generation << LINUX_HANDLE_GENERATION_SHIFT) |
+                          ((uintptr_t)slot << LINUX_HANDLE_SLOT_SHIFT);
+
+        if (client)
+        {
+            value |= LINUX_HANDLE_KIND_CLIENT;
+        }
+        return (socket_device_handle_t)value;
+    }
 
-    static int bsd_socket(int domain, int type, int protocol)
+    static bool linux_decode_handle(socket_device_handle_t handle, bool *client, uint16_t *slot, uint16_t *generation)
     {
-        return socket(domain, type, protocol);
+        uintptr_t value = (uintptr_t)handle;
+        uintptr_t low;
+
+        if (handle == SOCKET_DEVICE_INVALID_HANDLE)
+        {
+            return false;
+        }
+
+        low = value & LINUX_HANDLE_LOW_MASK;
+        *client = (low & LINUX_HANDLE_KIND_CLIENT) != 0U;
+        *slot = (uint16_t)((low >> LINUX_HANDLE_SLOT_SHIFT) & LINUX_HANDLE_SLOT_MASK);
+        *generation = (uint16_t)(value >> LINUX_HANDLE_GENERATION_SHIFT);
+
+        return (*generation != 0U && linux_make_handle(*client, *slot, *generation) == handle);
     }
 
-    static int bsd_bind(int sockfd, const struct sockaddr_in_ *addr, socklen_t addrlen)
+    /* returns the client slot of a live client handle or -1 */
+    static int linux_resolve_client(socket_device_handle_t handle)
     {
-        if (bind(sockfd, (const struct sockaddr *)addr, addrlen) < 0)
+        bool client;
+        uint16_t slot;
+        uint16_t generation;
+
+        if (!linux_decode_handle(handle, &client, &slot, &generation) || !client ||
+            slot >= LINUX_SOCKET_MAX_CLIENTS ||
+            linux_state.client_fds[slot] < 0 ||
+            linux_state.client_generations[slot] != generation)
         {
             return -1;
         }
-        /* set non-blocking */
-        int flags = fcntl(sockfd, F_GETFL, 0);
-        if (flags == -1)
-            return -1;
-        if (fcntl(sockfd, F_SETFL, flags | O_NONBLOCK) == -1)
+        return (int)slot;
+    }
+
+    /* returns the listener slot of a live listener handle or -1 */
+    static int linux_resolve_listener(socket_device_handle_t handle)
+    {
+        bool client;
+        uint16_t slot;
+        uint16_t generation;
+
+        if (!linux_decode_handle(handle, &client, &slot, &generation) || client ||
+            slot >= LINUX_SOCKET_MAX_LISTENERS ||
+            linux_state.listener_fds[slot] < 0 ||
+            linux_state.listener_generations[slot] != generation)
+        {
             return -1;
+        }
+        return (int)slot;
+    }
+
+    static int linux_epoll_ctl(int op, int fd, uint32_t events, socket_device_handle_t handle)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.u64 = (uint64_t)handle;
+        return epoll_ctl(linux_state.epoll_fd, op, fd, &ev);
+    }
+
+    static void linux_reset_client(uint16_t slot)
+    {
+        linux_state.client_fds[slot] = -1;
+        linux_state.client_tokens[slot] = SOCKET_DEVICE_INVALID_TOKEN;
+        /* Preserve generation so the next lifetime receives a different handle. */
+    }
+
+    static int linux_socket_map_io_error(int error)
+    {
+        switch (error)
+        {
+        case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+        case EWOULDBLOCK:
+#endif
+        case EINTR:
+        case ENOBUFS:
+            return SOCKET_DEVICE_WOULD_BLOCK;
+        case EBADF:
+        case ENOTSOCK:
+        case EINVAL:
+        case EFAULT:
+            return SOCKET_DEVICE_INVALID;
+        default:
+            return SOCKET_DEVICE_ERROR;
+        }
+    }
+
+    /*
+     * Releases a remotely/fatally closed client before notifying the core.
+     * Never used for local close(), which must not emit closed().
+     */
+    static int linux_fail_client(uint16_t slot, int reason)
+    {
+        int fd = linux_state.client_fds[slot];
+        socket_device_token_t token = linux_state.client_tokens[slot];
+
+        linux_reset_client(slot);
+        (void)epoll_ctl(linux_state.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+        (void)close(fd);
+        linux_state.events->closed(token, reason);
+        return reason;
+    }
+
+    /* kept for the emulator network startup; the epoll instance is created on device init */
+    int socket_init(void)
+    {
         return 0;
     }
 
-    static int bsd_listen(int sockfd, int backlog)
+    static int linux_socket_device_init(const socket_device_events_t *events)
+    {
+        if (!events || !events->accepted || !events->readable || !events->closed)
+        {
+            return SOCKET_DEVICE_INVALID;
+        }
+
+        if (linux_state.epoll_fd < 0)
+        {
+            linux_state.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            if (linux_state.epoll_fd < 0)
+            {
+                return SOCKET_DEVICE_ERROR;
+            }
+        }
+
+        for (uint16_t i = 0U; i < LINUX_SOCKET_MAX_LISTENERS; ++i)
+        {
+            linux_state.listener_fds[i] = -1;
+            linux_state.listener_generations[i] = 0U;
+        }
+        for (uint16_t i = 0U; i < LINUX_SOCKET_MAX_CLIENTS; ++i)
+        {
+            linux_state.client_generations[i] = 0U;
+            linux_reset_client(i);
+        }
+
+        /* a peer closing while a send is in flight must not raise SIGPIPE */
+        signal(SIGPIPE, SIG_IGN);
+
+        linux_state.events = events;
+        return SOCKET_DEVICE_OK;
+    }
+
+    static socket_device_handle_t linux_socket_listen(const socket_device_endpoint_t *endpoint, uint8_t backlog)
+    {
+        struct sockaddr_in address;
+        socket_device_handle_t handle;
+        uint16_t generation;
+        int slot = -1;
+        int fd;
+        int reuse = 1;
+
+        if (!linux_state.events || !endpoint || endpoint->port == 0U)
+        {
+            return SOCKET_DEVICE_INVALID_HANDLE;
+        }
+
+        for (uint16_t i = 0U; i < LINUX_SOCKET_MAX_LISTENERS; ++i)
+        {
+            if (linux_state.listener_fds[i] < 0)
+            {
+                slot = (int)i;
+                break;
+            }
+        }
+        if (slot < 0)
+        {
+            return SOCKET_DEVICE_INVALID_HANDLE;
+        }
+
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            return SOCKET_DEVICE_INVALID_HANDLE;
+        }
+
+        (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(endpoint->port);
+        address.sin_addr.s_addr = htonl(endpoint->address);
+
+        /* A zero backlog is a bounded request for one pending connection. */
+        generation = linux_next_generation(linux_state.listener_generations[slot]);
+        handle = linux_make_handle(false, (uint16_t)slot, generation);
+        if (bind(fd, (const struct sockaddr *)&address, sizeof(address)) < 0 ||
+            listen(fd, (backlog == 0U) ? 1 : (int)backlog) < 0 ||
+            linux_epoll_ctl(EPOLL_CTL_ADD, fd, EPOLLIN, handle) < 0)
+        {
+            (void)close(fd);
+            return SOCKET_DEVICE_INVALID_HANDLE;
+        }
+
+        linux_state.listener_generations[slot] = generation;
+        linux_state.listener_fds[slot] = fd;
+        return handle;
+    }
+
+    static int linux_socket_recv(socket_device_handle_t client, void *destination, size_t capacity)
     {
-        return listen(sockfd, backlog);
+        int slot = linux_resolve_client(client);
+        ssize_t result;
+
+        if (slot < 0)
+        {
+            return SOCKET_DEVICE_INVALID;
+        }
+        if (capacity == 0U)
+        {
+            return 0;
+        }
+        if (!destination)
+        {
+            return SOCKET_DEVICE_INVALID;
+        }
+
+        result = recv(linux_state.client_fds[slot], destination, (capacity > (size_t)INT_MAX) ? (size_t)INT_MAX : capacity, 0);
+        if (result > 0)
+        {
+            /* the readable hint stays latched and the core reads again until WOULD_BLOCK */
+            return (int)result;
+        }
+
+        if (result == 0)
+        {
+            return linux_fail_client((uint16_t)slot, SOCKET_DEVICE_CLOSED);
+        }
+
+        result = linux_socket_map_io_error(errno);
+        if (result == SOCKET_DEVICE_WOULD_BLOCK)
+        {
+            /* re-arms the descriptor so a future arrival notifies again */
+            if (linux_epoll_ctl(EPOLL_CTL_MOD, linux_state.client_fds[slot], LINUX_CLIENT_EVENTS, client) < 0)
+            {
+                return linux_fail_client((uint16_t)slot, SOCKET_DEVICE_ERROR);
+            }
+            return (int)result;
+        }
+
+        return linux_fail_client((uint16_t)slot, (int)result);
     }
 
-    static int bsd_accept(int sockfd, struct sockaddr_in_ *addr, socklen_t *addrlen)
+    static int linux_socket_send(socket_device_handle_t client, const void *source, size_t length)
     {
-        return accept(sockfd, (struct sockaddr *)addr, addrlen);
+        int slot = linux_resolve_client(client);
+        ssize_t result;
+
+        if (slot < 0)
+        {
+            return SOCKET_DEVICE_INVALID;
+        }
+        if (length == 0U)
+        {
+            return 0;
+        }
+        if (!source)
+        {
+            return SOCKET_DEVICE_INVALID;
+        }
+
+        /* exactly one non-blocking native send attempt */
+        result = send(linux_state.client_fds[slot], source, (length > (size_t)INT_MAX) ? (size_t)INT_MAX : length, MSG_NOSIGNAL);
+        if (result > 0)
+        {
+            return (int)result;
+        }
+
+        if (result == 0)
+        {
+            return SOCKET_DEVICE_WOULD_BLOCK;
+        }
+
+        result = linux_socket_map_io_error(errno);
+        if (result == SOCKET_DEVICE_WOULD_BLOCK)
+        {
+            return (int)result;
+        }
+
+        return linux_fail_client((uint16_t)slot, (int)result);
     }
 
-    static int bsd_setsockopt(int sockfd, int level, int optname, const void *optval, socklen_t optlen)
+    static int linux_socket_close(socket_device_handle_t handle)
     {
-        return setsockopt(sockfd, level, optname, optval, optlen);
+        int fd;
+        int slot = linux_resolve_client(handle);
+
+        if (slot >= 0)
+        {
+            fd = linux_state.client_fds[slot];
+            /* Local close owns no transport event; the core schedules disconnect. */
+            linux_reset_client((uint16_t)slot);
+        }
+        else
+        {
+            slot = linux_resolve_listener(handle);
+            if (slot < 0)
+            {
+                return SOCKET_DEVICE_INVALID;
+            }
+            fd = linux_state.listener_fds[slot];
+            linux_state.listener_fds[slot] = -1;
+        }
+
+        (void)epoll_ctl(linux_state.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+        return (close(fd) == 0) ? SOCKET_DEVICE_OK : SOCKET_DEVICE_ERROR;
     }
 
-    static int bsd_recv(int sockfd, void *buf, size_t len, int flags)
+    /* Accepts at most one native client per listener event. */
+    static void linux_poll_accept(uint16_t listener_slot, socket_device_handle_t listener)
     {
+        int client_slot = -1;
+        int fd = accept(linux_state.listener_fds[listener_slot], NULL, NULL);
+        if (fd < 0)
+        {
+            return;
+        }
 
-        int bytes = recv(sockfd, (char *)buf, (int)len, flags);
-        switch (errno)
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
         {
-        case EWOULDBLOCK:
-        case EAGAIN:
-            return -1;
+            (void)close(fd);
+            return;
+        }
+
+        for (uint16_t i = 0U; i < LINUX_SOCKET_MAX_CLIENTS; ++i)
+        {
+            if (linux_state.client_fds[i] < 0)
+            {
+                client_slot = (int)i;
+                break;
+            }
+        }
+        if (client_slot < 0)
+        {
+            (void)close(fd);
+            return;
         }
 
-        return bytes;
+        uint16_t generation = linux_next_generation(linux_state.client_generations[client_slot]);
+        socket_device_handle_t handle = linux_make_handle(true, (uint16_t)client_slot, generation);
+        linux_state.client_generations[client_slot] = generation;
+        linux_state.client_fds[client_slot] = fd;
+        linux_state.client_tokens[client_slot] = SOCKET_DEVICE_INVALID_TOKEN;
+
+        socket_device_token_t token = linux_state.events->accepted(listener, handle);
+        if (token == SOCKET_DEVICE_INVALID_TOKEN)
+        {
+            /* Rejected clients never own a token and never emit closed(). */
+            linux_reset_client((uint16_t)client_slot);
+            (void)close(fd);
+            return;
+        }
+
+        linux_state.client_tokens[client_slot] = token;
+        /* armed only after the token exists so no event precedes it */
+        if (linux_epoll_ctl(EPOLL_CTL_ADD, fd, LINUX_CLIENT_EVENTS, handle) < 0)
+        {
+            (void)linux_fail_client((uint16_t)client_slot, SOCKET_DEVICE_ERROR);
+        }
     }
 
-    static int bsd_send(int sockfd, const void *buf, size_t len, int flags)
+    static void linux_socket_poll(uint16_t budget)
     {
-        return send(sockfd, buf, len, flags);
+        struct epoll_event events[LINUX_SOCKET_MAX_EVENTS];
+        int ready;
+
+        if (!linux_state.events || budget == 0U)
+        {
+            return;
+        }
+
+        /* each ready descriptor emits at most one event so the budget caps the batch */
+        ready = epoll_wait(linux_state.epoll_fd, events, (budget < LINUX_SOCKET_MAX_EVENTS) ? (int)budget : LINUX_SOCKET_MAX_EVENTS, 0);
+        for (int i = 0; i < ready; ++i)
+        {
+            socket_device_handle_t handle = (socket_device_handle_t)events[i].data.u64;
+            int slot = linux_resolve_client(handle);
+            if (slot >= 0)
+            {
+                if (linux_state.client_tokens[slot] != SOCKET_DEVICE_INVALID_TOKEN)
+                {
+                    linux_state.events->readable(linux_state.client_tokens[slot]);
+                }
+                continue;
+            }
+
+            /* stale events of closed descriptors are ignored */
+            slot = linux_resolve_listener(handle);
+            if (slot >= 0)
+            {
+                linux_poll_accept((uint16_t)slot, handle);
+            }
+        }
     }
 
-    static int bsd_close(int fd)
+    /* there is no OTA server in the emulator */
+    void __attribute__((weak)) ota_server_start(void)
     {
-        return close(fd);
     }
 
+    /* Existing emulator integration symbol retained for compatibility. */
     socket_device_t wifi_socket = {
-        .socket = bsd_socket,
-        .bind = bsd_bind,
-        .listen = bsd_listen,
-        .accept = bsd_accept,
-        .recv = bsd_recv,
-        .send = bsd_send,
-        .close = bsd_close};
+        .init = linux_socket_device_init,
+        .listen = linux_socket_listen,
+        .recv = linux_socket_recv,
+        .send = linux_socket_send,
+        .close = linux_socket_close,
+        .poll = linux_socket_poll};
 
 #endif /* ENABLE_SOCKETS */
 
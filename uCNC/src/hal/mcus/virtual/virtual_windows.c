@@ -459,9 +459,11 @@ extern "C"
     }
     bool flash_fs_remove(const char *path)
     {
-        (void)path;
+        /* paths are relative to the working dir like on open */
+        char file[256] = ".";
+        strncat(file, path, sizeof(file) - strlen(file) - 1);
         if (flash_fs.drive)
-            return remove(path) == 0;
+            return remove(file) == 0;
         return false;
     }
     bool flash_fs_mkdir(const char *path)
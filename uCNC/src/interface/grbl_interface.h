@@ -111,6 +111,7 @@ extern "C"
 #define STATUS_MAXIMUM_PARAMS_PER_BLOCK_EXCEEDED 60
 #define STATUS_PROBE_UNSUCCESS 61
 #define STATUS_SPINDLE_RPM_ERROR 62
+#define STATUS_PARAMETERS_STORAGE_FULL 63
 #define STATUS_CRITICAL_FAIL 254
 #define STATUS_NO_CMD 255
 
@@ -136,6 +137,8 @@ extern "C"
 #define GRBL_SEND_SYSTEM_INFO (GRBL_SYSTEM_CMD + 14)
 #define GRBL_SEND_SYSTEM_INFO_EXTENDED (GRBL_SYSTEM_CMD + 15)
 #define GRBL_PRINT_PARAM (GRBL_SYSTEM_CMD + 16)
+#define GRBL_SEND_BOOT_PROFILE (GRBL_SYSTEM_CMD + 17)
+#define GRBL_SEND_MODULE_PROFILE (GRBL_SYSTEM_CMD + 18)
 
 #define GRBL_SYSTEM_CMD_EXTENDED (GRBL_SYSTEM_CMD + 20)
 #define GRBL_SYSTEM_CMD_EXTENDED_UNSUPPORTED 253
@@ -213,10 +213,6 @@ const char *const inputpins_names[] __rom__ = {pin_name_100, pin_name_101, pin_n
 
 #endif
 
-#ifndef MAX_MODAL_GROUPS
-#define MAX_MODAL_GROUPS 14
-#endif
-
 static bool protocol_busy;
 
 #ifdef ENABLE_IO_MODULES
@@ -290,6 +286,50 @@ void proto_error(uint8_t error)
 	proto_print(MSG_EOL);
 }
 
+#ifdef ENABLE_STREAM_WINDOW
+static void proto_window_print(grbl_stream_t *stream, uint8_t error)
+{
+	proto_print("[ACK:");
+	proto_itoa(stream->window_seq);
+	if (error != STATUS_OK)
+	{
+		proto_print("|E:");
+		proto_itoa(error);
+	}
+	proto_print(MSG_FEEDBACK_END);
+}
+
+/**
+ * Replaces the ok/error response of a line of a windowed stream
+ * Errors are acknowledged immediately and successful lines are batched
+ * */
+void proto_window_ack(uint8_t error)
+{
+	grbl_stream_t *stream = grbl_stream_window_line(error != STATUS_OK);
+	if (stream)
+	{
+		proto_window_print(stream, error);
+	}
+}
+
+/**
+ * Sends the batched acks that timed out
+ * */
+void proto_window_flush(void)
+{
+	if (protocol_busy || grbl_stream_busy())
+	{
+		return;
+	}
+
+	grbl_stream_t *stream = NULL;
+	while ((stream = grbl_stream_window_next(stream)))
+	{
+		proto_window_print(stream, STATUS_OK);
+	}
+}
+#endif
+
 void proto_alarm(int8_t alarm)
 {
 	grbl_stream_start_broadcast();
@@ -317,7 +357,7 @@ WEAK_EVENT_HANDLER(proto_status)
 	{
 		if (ptr->fptr != NULL)
 		{
-			ptr->fptr(args);
+			EVENT_LISTENER_CALL(ptr, args);
 		}
 		ptr = ptr->next;
 	}
@@ -325,6 +365,63 @@ WEAK_EVENT_HANDLER(proto_status)
 	return EVENT_CONTINUE;
 }
 
+static void proto_status_pins(uint8_t controls, uint8_t limits, bool probe)
+{
+	if (CHECKFLAG(controls, ESTOP_MASK))
+	{
+		proto_putc('R');
+	}
+
+	if (CHECKFLAG(controls, SAFETY_DOOR_MASK))
+	{
+		proto_putc('D');
+	}
+
+	if (CHECKFLAG(controls, FHOLD_MASK))
+	{
+		proto_putc('H');
+	}
+
+	if (probe)
+	{
+		proto_putc('P');
+	}
+
+	if (CHECKFLAG(limits, LINACT0_LIMIT_MASK))
+	{
+		proto_putc('X');
+	}
+
+	if (CHECKFLAG(limits, LINACT1_LIMIT_MASK))
+	{
+#if ((AXIS_COUNT == 2) && defined(USE_Y_AS_Z_ALIAS))
+		proto_putc('Z');
+#else
+		proto_putc('Y');
+#endif
+	}
+
+	if (CHECKFLAG(limits, LINACT2_LIMIT_MASK))
+	{
+		proto_putc('Z');
+	}
+
+	if (CHECKFLAG(limits, LINACT3_LIMIT_MASK))
+	{
+		proto_putc('A');
+	}
+
+	if (CHECKFLAG(limits, LINACT4_LIMIT_MASK))
+	{
+		proto_putc('B');
+	}
+
+	if (CHECKFLAG(limits, LINACT5_LIMIT_MASK))
+	{
+		proto_putc('C');
+	}
+}
+
 static FORCEINLINE void proto_status_tail(void)
 {
 	float axis[MAX(AXIS_COUNT, 3)];
@@ -386,6 +483,149 @@ static FORCEINLINE void proto_status_tail(void)
 	g_planner_state.ovr_counter--;
 }
 
+#ifdef ENABLE_STATUS_ROUTING
+#define STATUS_HASH_INIT 0x811C9DC5UL
+#define STATUS_HASH_PRIME 0x01000193UL
+static uint32_t proto_status_hash_step(uint32_t hash, const void *data, uint8_t len)
+{
+	const uint8_t *ptr = (const uint8_t *)data;
+	while (len--)
+	{
+		hash ^= *ptr++;
+		hash *= STATUS_HASH_PRIME;
+	}
+	return hash;
+}
+#endif
+
+#ifdef ENABLE_STATUS_PUSH
+/**
+ * Fingerprints the state reported in the status message
+ * Used by the on change subscriptions to skip unchanged reports
+ * */
+static uint32_t proto_status_hash(void)
+{
+	uint32_t hash = STATUS_HASH_INIT;
+	int32_t steppos[AXIS_TO_STEPPERS];
+	io_get_steps_pos(steppos);
+	hash = proto_status_hash_step(hash, steppos, sizeof(steppos));
+	float feed = itp_get_rt_feed();
+	hash = proto_status_hash_step(hash, &feed, sizeof(feed));
+#if TOOL_COUNT > 0
+	uint16_t spindle = tool_get_speed();
+	hash = proto_status_hash_step(hash, &spindle, sizeof(spindle));
+#endif
+	uint8_t flags[7];
+	flags[0] = io_get_controls();
+	flags[1] = io_get_raw_limits();
+	flags[2] = io_get_probe();
+	flags[3] = cnc_get_status();
+	flags[4] = g_planner_state.feed_override;
+	flags[5] = g_planner_state.rapid_feed_override;
+#if TOOL_COUNT > 0
+	flags[6] = g_planner_state.spindle_speed_override;
+#else
+	flags[6] = 0;
+#endif
+	return proto_status_hash_step(hash, flags, sizeof(flags));
+}
+
+void proto_status_push(void)
+{
+	// only fingerprints the state if a subscriber is due
+	if (protocol_busy || grbl_stream_busy() || !grbl_stream_status_push_due())
+	{
+		return;
+	}
+
+	if (grbl_stream_status_push_start(proto_status_hash()))
+	{
+		proto_status();
+	}
+}
+#endif
+
+#ifdef ENABLE_STATUS_COMPACT
+/**
+ * Prints the compact status report to the current status target
+ * Only the fields that changed since the last report to that stream are sent
+ * */
+static void proto_status_compact(uint32_t *fields)
+{
+	int32_t steppos[AXIS_TO_STEPPERS];
+	io_get_steps_pos(steppos);
+	uint16_t feed = (uint16_t)lroundf((!g_settings.report_inches) ? itp_get_rt_feed() : (itp_get_rt_feed() * MM_INCH_MULT));
+#if TOOL_COUNT > 0
+	uint16_t spindle = tool_get_speed();
+#else
+	uint16_t spindle = 0;
+#endif
+	uint8_t pins[3];
+	pins[0] = io_get_controls() & (ESTOP_MASK | SAFETY_DOOR_MASK | FHOLD_MASK);
+	pins[1] = io_get_raw_limits() & LIMITS_MASK;
+	pins[2] = io_get_probe();
+	uint8_t state = cnc_get_status();
+
+	uint32_t hash[STATUS_COMPACT_FIELDS];
+	hash[0] = proto_status_hash_step(STATUS_HASH_INIT, &state, sizeof(state));
+	hash[1] = proto_status_hash_step(STATUS_HASH_INIT, steppos, sizeof(steppos));
+	hash[2] = proto_status_hash_step(proto_status_hash_step(STATUS_HASH_INIT, &feed, sizeof(feed)), &spindle, sizeof(spindle));
+	hash[3] = proto_status_hash_step(STATUS_HASH_INIT, pins, sizeof(pins));
+
+	bool sep = false;
+	proto_putc('{');
+	for (uint8_t i = 0; i < STATUS_COMPACT_FIELDS; i++)
+	{
+		if (fields[i] == hash[i])
+		{
+			continue;
+		}
+
+		fields[i] = hash[i];
+		if (sep)
+		{
+			proto_putc('|');
+		}
+		sep = true;
+
+		switch (i)
+		{
+		case 0:
+			proto_print("S:");
+			proto_itoa(state);
+			break;
+		case 1:
+			proto_print("P:");
+			for (uint8_t j = 0; j < AXIS_TO_STEPPERS; j++)
+			{
+				if (j)
+				{
+					proto_putc(',');
+				}
+				if (steppos[j] < 0)
+				{
+					proto_putc('-');
+					steppos[j] = -steppos[j];
+				}
+				proto_itoa(steppos[j]);
+			}
+			break;
+		case 2:
+			proto_print("F:");
+			proto_itoa(feed);
+			proto_putc(',');
+			proto_itoa(spindle);
+			break;
+		case 3:
+			proto_print("Pn:");
+			proto_status_pins(pins[0], pins[1], pins[2]);
+			break;
+		}
+	}
+	proto_print("}" STR_EOL);
+}
+#endif
+
 void proto_status(void)
 {
 	if (protocol_busy || grbl_stream_busy())
@@ -393,7 +633,28 @@ void proto_status(void)
 		return;
 	}
 
+#ifdef ENABLE_STATUS_COMPACT
+	grbl_stream_t *stream = NULL;
+	while ((stream = grbl_stream_status_compact_next(stream)))
+	{
+#ifdef ENABLE_STREAM_TX_QUEUE
+		grbl_stream_mark_status();
+#endif
+		proto_status_compact(stream->status_fields);
+	}
+#endif
+
+#ifdef ENABLE_STATUS_ROUTING
+	if (!grbl_stream_status_broadcast())
+	{
+		return;
+	}
+#else
 	grbl_stream_start_broadcast();
+#endif
+#ifdef ENABLE_STREAM_TX_QUEUE
+	grbl_stream_mark_status();
+#endif
 
 	float axis[MAX(AXIS_COUNT, 3)];
 #if AXIS_COUNT < 3
@@ -530,60 +791,7 @@ void proto_status(void)
 	if (CHECKFLAG(controls, (ESTOP_MASK | SAFETY_DOOR_MASK | FHOLD_MASK)) || CHECKFLAG(limits, LIMITS_MASK) || probe)
 	{
 		proto_print(MSG_STATUS_PIN);
-
-		if (CHECKFLAG(controls, ESTOP_MASK))
-		{
-			proto_putc('R');
-		}
-
-		if (CHECKFLAG(controls, SAFETY_DOOR_MASK))
-		{
-			proto_putc('D');
-		}
-
-		if (CHECKFLAG(controls, FHOLD_MASK))
-		{
-			proto_putc('H');
-		}
-
-		if (probe)
-		{
-			proto_putc('P');
-		}
-
-		if (CHECKFLAG(limits, LINACT0_LIMIT_MASK))
-		{
-			proto_putc('X');
-		}
-
-		if (CHECKFLAG(limits, LINACT1_LIMIT_MASK))
-		{
-#if ((AXIS_COUNT == 2) && defined(USE_Y_AS_Z_ALIAS))
-			proto_putc('Z');
-#else
-			proto_putc('Y');
-#endif
-		}
-
-		if (CHECKFLAG(limits, LINACT2_LIMIT_MASK))
-		{
-			proto_putc('Z');
-		}
-
-		if (CHECKFLAG(limits, LINACT3_LIMIT_MASK))
-		{
-			proto_putc('A');
-		}
-
-		if (CHECKFLAG(limits, LINACT4_LIMIT_MASK))
-		{
-			proto_putc('B');
-		}
-
-		if (CHECKFLAG(limits, LINACT5_LIMIT_MASK))
-		{
-			proto_putc('C');
-		}
+		proto_status_pins(controls, limits, probe);
 	}
 
 	proto_status_tail();
@@ -1098,7 +1306,7 @@ WEAK_EVENT_HANDLER(proto_cnc_info)
 	{
 		if (ptr->fptr != NULL)
 		{
-			ptr->fptr(args);
+			EVENT_LISTENER_CALL(ptr, args);
 			proto_putc(',');
 		}
 		ptr = ptr->next;
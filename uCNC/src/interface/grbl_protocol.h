@@ -39,6 +39,13 @@ extern "C"
 	void proto_alarm(int8_t alarm);
 	void proto_status(void);
 	DECL_EVENT_HANDLER(proto_status);
+#ifdef ENABLE_STATUS_PUSH
+	void proto_status_push(void);
+#endif
+#ifdef ENABLE_STREAM_WINDOW
+	void proto_window_ack(uint8_t error);
+	void proto_window_flush(void);
+#endif
 	void proto_feedback_fmt(const char *fmt, ...);
 #define proto_feedback(__s) proto_print(MSG_FEEDBACK_START __s MSG_FEEDBACK_END)
 #define proto_info(__s, ...) proto_feedback_fmt(__romstr__(__s), ##__VA_ARGS__)
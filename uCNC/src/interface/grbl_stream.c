@@ -51,6 +51,12 @@ DECL_GRBL_STREAM(usb_grbl_stream, mcu_usb_getc, mcu_usb_available, mcu_usb_clear
 #endif
 #if defined(ENABLE_SOCKETS) && !defined(DETACH_TELNET_FROM_MAIN_PROTOCOL)
 DECL_GRBL_STREAM(telnet_grbl_stream, mcu_telnet_getc, mcu_telnet_available, mcu_telnet_clear, mcu_telnet_putc, mcu_telnet_flush);
+#ifdef ENABLE_STREAM_TX_QUEUE
+static grbl_stream_tx_queue_t telnet_tx_queue = {mcu_telnet_write_available};
+#endif
+#endif
+#if defined(ENABLE_SOCKETS) && defined(ENABLE_WEBSOCKET_GCODE)
+DECL_GRBL_STREAM(ws_gcode_grbl_stream, mcu_ws_gcode_getc, mcu_ws_gcode_available, mcu_ws_gcode_clear, mcu_ws_gcode_putc, mcu_ws_gcode_flush);
 #endif
 #if defined(MCU_HAS_BLUETOOTH) && !defined(DETACH_BLUETOOTH_FROM_MAIN_PROTOCOL)
 DECL_GRBL_STREAM(bt_grbl_stream, mcu_bt_getc, mcu_bt_available, mcu_bt_clear, mcu_bt_putc, mcu_bt_flush);
@@ -77,9 +83,15 @@ void grbl_stream_init(void)
 #if defined(ENABLE_SOCKETS) && !defined(DETACH_TELNET_FROM_MAIN_PROTOCOL)
 	grbl_stream_register(&telnet_grbl_stream);
 #endif
+#if defined(ENABLE_SOCKETS) && defined(ENABLE_WEBSOCKET_GCODE)
+	grbl_stream_register(&ws_gcode_grbl_stream);
+#endif
 #if defined(MCU_HAS_BLUETOOTH) && !defined(DETACH_BLUETOOTH_FROM_MAIN_PROTOCOL)
 	grbl_stream_register(&bt_grbl_stream);
 #endif
+#if defined(ENABLE_STREAM_TX_QUEUE) && defined(ENABLE_SOCKETS) && !defined(DETACH_TELNET_FROM_MAIN_PROTOCOL)
+	telnet_grbl_stream.tx_queue = &telnet_tx_queue;
+#endif
 #endif
 
 	grbl_stream_change(NULL);
@@ -238,11 +250,22 @@ void grbl_stream_eeprom(uint16_t address)
 	grbl_stream_readonly(&stream_eeprom_getc, NULL, NULL);
 }
 
+#ifdef ENABLE_STREAM_WINDOW
+// raw char of the last line ending read
+static char grbl_stream_last_eol;
+#endif
+
 char grbl_stream_getc(void)
 {
 	uint8_t peek = grbl_stream_peek();
 #ifdef ENABLE_MULTISTREAM_GUARD
 	grbl_stream_rx_busy = (peek != EOL);
+#endif
+#ifdef ENABLE_STREAM_WINDOW
+	if (peek == EOL)
+	{
+		grbl_stream_last_eol = grbl_stream_peek_buffer;
+	}
 #endif
 	grbl_stream_peek_buffer = 0;
 	return peek;
@@ -394,7 +417,203 @@ void grbl_stream_clear(void)
 
 #ifndef DISABLE_MULTISTREAM_SERIAL
 static bool grbl_stream_broadcast_enabled;
+// the broadcast only goes to this stream
+static grbl_stream_t *grbl_stream_unicast_target;
+#endif
+#ifdef ENABLE_STATUS_ROUTING
+// the broadcast only goes to the streams flagged with status_due
+static bool grbl_stream_status_filter;
+
+/**
+ * Starts the broadcast of the standard status report
+ * Streams using the compact report or without a status push due are skipped
+ * Returns false if there is no stream left to send the report to
+ * */
+bool grbl_stream_status_broadcast(void)
+{
+	bool any = false;
+	grbl_stream_t *p = default_stream;
+	while (p)
+	{
+		p->status_due = (p->status_due || !grbl_stream_status_filter);
+#ifdef ENABLE_STATUS_COMPACT
+		p->status_due = (p->status_due && !p->status_compact);
 #endif
+		any |= p->status_due;
+		p = p->next;
+	}
+
+	grbl_stream_status_filter = any;
+	grbl_stream_broadcast_enabled = any;
+	return any;
+}
+#endif
+
+#ifdef ENABLE_STATUS_PUSH
+void grbl_stream_status_subscribe(uint16_t interval, bool on_change)
+{
+	current_stream->status_interval = interval;
+	current_stream->status_on_change = on_change;
+	current_stream->status_next = mcu_millis();
+	// forces the first report
+	current_stream->status_hash = ~current_stream->status_hash;
+}
+
+/**
+ * Checks if any subscribed stream has a status push due
+ * Allows skipping the status fingerprint when no push can happen
+ * */
+bool grbl_stream_status_push_due(void)
+{
+	uint32_t now = mcu_millis();
+	grbl_stream_t *p = default_stream;
+	while (p)
+	{
+		if (p->status_interval && (int32_t)(now - p->status_next) >= 0)
+		{
+			return true;
+		}
+		p = p->next;
+	}
+
+	return false;
+}
+
+/**
+ * Marks the subscribed streams that should receive the status report
+ * If any stream is due starts a broadcast to those streams only
+ * */
+bool grbl_stream_status_push_start(uint32_t hash)
+{
+	uint32_t now = mcu_millis();
+	bool any = false;
+	grbl_stream_t *p = default_stream;
+	while (p)
+	{
+		p->status_due = false;
+		if (p->status_interval && (int32_t)(now - p->status_next) >= 0)
+		{
+			p->status_next = now + p->status_interval;
+			if (!p->status_on_change || p->status_hash != hash)
+			{
+				p->status_hash = hash;
+				p->status_due = true;
+				any = true;
+			}
+		}
+		p = p->next;
+	}
+
+	grbl_stream_status_filter = any;
+	return any;
+}
+#endif
+
+#ifdef ENABLE_STATUS_COMPACT
+void grbl_stream_status_compact(bool enable)
+{
+	current_stream->status_compact = enable;
+	// forces a full report on the next status
+	for (uint8_t i = 0; i < STATUS_COMPACT_FIELDS; i++)
+	{
+		current_stream->status_fields[i] = ~current_stream->status_fields[i];
+	}
+}
+
+/**
+ * Iterates the streams that should receive a compact status report
+ * Each returned stream becomes the only output until the end of the line
+ * */
+grbl_stream_t *grbl_stream_status_compact_next(grbl_stream_t *stream)
+{
+	grbl_stream_t *p = (!stream) ? default_stream : stream->next;
+	while (p)
+	{
+		if (p->status_compact && (p->status_due || !grbl_stream_status_filter))
+		{
+			grbl_stream_start_unicast(p);
+			return p;
+		}
+		p = p->next;
+	}
+
+	return NULL;
+}
+#endif
+#ifdef ENABLE_STREAM_WINDOW
+void grbl_stream_window(uint8_t ack_lines)
+{
+	// line numbering restarts only when a new window is opened
+	if (!current_stream->window_ack)
+	{
+		current_stream->window_pending = 0;
+		current_stream->window_seq = 0;
+	}
+	current_stream->window_ack = ack_lines;
+}
+
+bool grbl_stream_window_active(void)
+{
+	// lines read from files or eeprom are not part of the window
+	return (current_stream->window_ack && stream_getc == current_stream->stream_getc);
+}
+
+/**
+ * Checks if the next char is a LF right after a CR line ending
+ * Both are the same line ending (CR+LF) and only count as one line
+ * */
+bool grbl_stream_window_crlf(void)
+{
+	return (grbl_stream_peek_buffer == '\n' && grbl_stream_last_eol == '\r');
+}
+
+/**
+ * Accounts a line read from the current stream
+ * If the ack is due (or forced) starts the unicast to the stream and returns it
+ * Otherwise the ack is batched and returns NULL
+ * */
+grbl_stream_t *grbl_stream_window_line(bool force)
+{
+	grbl_stream_t *p = current_stream;
+	p->window_seq++;
+	if (!p->window_pending++)
+	{
+		p->window_timeout = mcu_millis() + STREAM_WINDOW_ACK_INTERVAL;
+	}
+
+	if (force || p->window_pending >= p->window_ack)
+	{
+		p->window_pending = 0;
+		grbl_stream_start_unicast(p);
+		return p;
+	}
+
+	return NULL;
+}
+
+/**
+ * Iterates the streams with batched acks that timed out
+ * Each returned stream becomes the only output until the end of the line
+ * */
+grbl_stream_t *grbl_stream_window_next(grbl_stream_t *stream)
+{
+	uint32_t now = mcu_millis();
+	grbl_stream_t *p = (!stream) ? default_stream : stream->next;
+	while (p)
+	{
+		if (p->window_pending && (int32_t)(now - p->window_timeout) >= 0)
+		{
+			p->window_pending = 0;
+			grbl_stream_start_unicast(p);
+			return p;
+		}
+		p = p->next;
+	}
+
+	return NULL;
+}
+#endif
+
 void grbl_stream_start_broadcast(void)
 {
 #ifndef DISABLE_MULTISTREAM_SERIAL
@@ -402,27 +621,190 @@ void grbl_stream_start_broadcast(void)
 #endif
 }
 
+/**
+ * Sends the next line to the given stream only (the stream does not need to be the current one)
+ * */
+void grbl_stream_start_unicast(grbl_stream_t *stream)
+{
+#ifndef DISABLE_MULTISTREAM_SERIAL
+	grbl_stream_broadcast_enabled = true;
+	grbl_stream_unicast_target = stream;
+#endif
+}
+
 static uint8_t grbl_stream_tx_count;
+
+#ifdef ENABLE_STREAM_TX_QUEUE
+// only streams that can report how much they can take are queued
+// all other streams are written directly
+#define TX_QUEUE_ENABLED(p) ((p)->tx_queue != NULL)
+#else
+#define TX_QUEUE_ENABLED(p) false
+#endif
+
+#ifdef ENABLE_STREAM_TX_QUEUE
+// the current line is a status report and can be dropped
+static bool grbl_stream_tx_droppable;
+
+#define TX_QUEUE_NEXT(i) (((i) + 1) < STREAM_TX_QUEUE_SIZE ? ((i) + 1) : 0)
+#define TX_QUEUE_USED(from, to) ((to) >= (from) ? ((to) - (from)) : (STREAM_TX_QUEUE_SIZE + (to) - (from)))
+
+/**
+ * Marks the line being printed as a status report
+ * Status reports are coalesced or dropped if a stream queue is full
+ * */
+void grbl_stream_mark_status(void)
+{
+	grbl_stream_tx_droppable = true;
+}
+
+/**
+ * Moves the queued chars to the stream as long as the stream can take them without blocking
+ * */
+static void grbl_stream_tx_drain(grbl_stream_t *p)
+{
+	grbl_stream_tx_queue_t *q = p->tx_queue;
+	if (!q)
+	{
+		return;
+	}
+
+	uint8_t tail = q->tail;
+	uint8_t head = q->head;
+	uint8_t count = q->write_available();
+	bool sent = false;
+	while (tail != head && count)
+	{
+		if (p->stream_putc)
+		{
+			p->stream_putc(q->buffer[tail]);
+		}
+		tail = TX_QUEUE_NEXT(tail);
+		count--;
+		sent = true;
+	}
+	q->tail = tail;
+
+	// also keeps a stream that is blocked going
+	if ((sent || !count) && p->stream_flush)
+	{
+		p->stream_flush();
+	}
+}
+
+void grbl_stream_tx_flush(void)
+{
+	grbl_stream_t *p = default_stream;
+	while (p)
+	{
+		grbl_stream_tx_drain(p);
+		p = p->next;
+	}
+}
+
+static void grbl_stream_tx_putc(grbl_stream_t *p, uint8_t c)
+{
+	grbl_stream_tx_queue_t *q = p->tx_queue;
+	uint8_t head = q->head;
+
+	// first char of the line
+	if (grbl_stream_tx_count == 1)
+	{
+		q->drop = false;
+		if (!grbl_stream_tx_droppable)
+		{
+			q->status_queued = false;
+		}
+		// replaces the previous status if it's the last queued line and it's still untouched
+		else if (q->status_queued && head == q->status_end && TX_QUEUE_USED(q->tail, head) >= TX_QUEUE_USED(q->status, head))
+		{
+			head = q->status;
+		}
+		q->line = head;
+	}
+
+	if (q->drop)
+	{
+		return;
+	}
+
+	while (TX_QUEUE_NEXT(head) == q->tail)
+	{
+		if (grbl_stream_tx_droppable)
+		{
+			// drops the status line
+			q->head = q->line;
+			q->status_queued = false;
+			q->drop = true;
+			return;
+		}
+		// strict delivery waits for room
+		// keeps the communications and the motion going meanwhile
+		// a stalled telnet client is dropped after GRBL_TELNET_TIMEOUT and frees the queue
+		// calling these from inside putc is safe since none of them prints
+		// mcu_dotasks only polls the communications (received chars go to the RX buffers and realtime commands only set flags handled later by cnc_dotasks)
+		// and itp_run only moves the planner blocks to the segment buffer
+		grbl_stream_tx_drain(p);
+		mcu_dotasks();
+#ifndef ENABLE_ITP_FEED_TASK
+		itp_run();
+#endif
+	}
+
+	q->buffer[head] = c;
+	head = TX_QUEUE_NEXT(head);
+	q->head = head;
+
+	if (c == '\n' && grbl_stream_tx_droppable)
+	{
+		q->status = q->line;
+		q->status_end = head;
+		q->status_queued = true;
+	}
+}
+#endif
+
+static FORCEINLINE void grbl_stream_write(grbl_stream_t *p, uint8_t c)
+{
+#ifdef ENABLE_STREAM_TX_QUEUE
+	if (TX_QUEUE_ENABLED(p))
+	{
+		grbl_stream_tx_putc(p, c);
+		return;
+	}
+#endif
+	if (p->stream_putc)
+	{
+		p->stream_putc(c);
+	}
+}
+
 void grbl_stream_putc(char c)
 {
 	grbl_stream_tx_count++;
 #ifndef DISABLE_MULTISTREAM_SERIAL
 	if (!grbl_stream_broadcast_enabled)
 	{
-		if (current_stream->stream_putc)
-		{
-			current_stream->stream_putc(c);
-		}
+		grbl_stream_write(current_stream, (uint8_t)c);
 	}
 	else
 	{
 		grbl_stream_t *p = default_stream;
 		while (p)
 		{
-			if (p->stream_putc)
+			if (grbl_stream_unicast_target && grbl_stream_unicast_target != p)
 			{
-				p->stream_putc((uint8_t)c);
+				p = p->next;
+				continue;
 			}
+#ifdef ENABLE_STATUS_ROUTING
+			if (grbl_stream_status_filter && !p->status_due)
+			{
+				p = p->next;
+				continue;
+			}
+#endif
+			grbl_stream_write(p, (uint8_t)c);
 			p = p->next;
 		}
 	}
@@ -433,9 +815,20 @@ void grbl_stream_putc(char c)
 	if (c == '\n')
 	{
 		grbl_stream_tx_count = 0;
+#ifdef ENABLE_STREAM_TX_QUEUE
+		grbl_stream_tx_droppable = false;
+#endif
 		grbl_stream_flush();
 #ifndef DISABLE_MULTISTREAM_SERIAL
 		grbl_stream_broadcast_enabled = false;
+#ifdef ENABLE_STATUS_ROUTING
+		// a unicast line keeps the filter for the remaining status lines
+		if (!grbl_stream_unicast_target)
+		{
+			grbl_stream_status_filter = false;
+		}
+#endif
+		grbl_stream_unicast_target = NULL;
 #endif
 #ifdef ENABLE_DEBUG_STREAM
 		debug_flush();
@@ -456,10 +849,14 @@ void grbl_stream_printf(const char *fmt, ...)
 
 void grbl_stream_flush(void)
 {
+#ifdef ENABLE_STREAM_TX_QUEUE
+	// sends what it can without blocking and leaves the rest to the main loop
+	grbl_stream_tx_flush();
+#endif
 #ifndef DISABLE_MULTISTREAM_SERIAL
 	if (!grbl_stream_broadcast_enabled)
 	{
-		if (current_stream->stream_flush)
+		if (current_stream->stream_flush && !TX_QUEUE_ENABLED(current_stream))
 		{
 			current_stream->stream_flush();
 		}
@@ -469,7 +866,7 @@ void grbl_stream_flush(void)
 		grbl_stream_t *p = default_stream;
 		while (p)
 		{
-			if (p->stream_flush)
+			if (p->stream_flush && !TX_QUEUE_ENABLED(p))
 			{
 				p->stream_flush();
 			}
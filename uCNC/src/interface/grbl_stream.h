@@ -41,9 +41,29 @@ extern "C"
 #error "RX_BUFFER_SIZE cannot exceed 255"
 #endif
 
+#define STATUS_COMPACT_FIELDS 4
+
 	typedef uint8_t (*grbl_stream_getc_cb)(void);
 	typedef uint8_t (*grbl_stream_available_cb)(void);
 	typedef void (*grbl_stream_clear_cb)(void);
+	typedef uint8_t (*grbl_stream_write_available_cb)(void);
+
+#ifdef ENABLE_STREAM_TX_QUEUE
+	// output queue of a stream that can report how many chars it can take without blocking
+	typedef struct grbl_stream_tx_queue_
+	{
+		grbl_stream_write_available_cb write_available;
+		uint8_t buffer[STREAM_TX_QUEUE_SIZE];
+		uint8_t head;
+		uint8_t tail;
+		uint8_t line;
+		// the last status line queued
+		uint8_t status;
+		uint8_t status_end;
+		bool status_queued;
+		bool drop;
+	} grbl_stream_tx_queue_t;
+#endif
 
 	typedef struct grbl_stream_
 	{
@@ -54,6 +74,33 @@ extern "C"
 		void (*stream_flush)(void);
 		struct grbl_stream_ *next;
 		bool registered;
+#ifdef ENABLE_STATUS_ROUTING
+		bool status_due;
+#endif
+#ifdef ENABLE_STATUS_PUSH
+		// status push subscription
+		uint16_t status_interval;
+		bool status_on_change;
+		uint32_t status_next;
+		uint32_t status_hash;
+#endif
+#ifdef ENABLE_STATUS_COMPACT
+		// fingerprint of each field in the last compact report sent
+		bool status_compact;
+		uint32_t status_fields[STATUS_COMPACT_FIELDS];
+#endif
+#ifdef ENABLE_STREAM_WINDOW
+		// windowed streaming protocol
+		uint8_t window_ack;
+		uint8_t window_pending;
+		// line number of the last acknowledged line (wraps from 65535 to 0)
+		uint16_t window_seq;
+		uint32_t window_timeout;
+#endif
+#ifdef ENABLE_STREAM_TX_QUEUE
+		// optional, streams without a queue are written directly
+		grbl_stream_tx_queue_t *tx_queue;
+#endif
 	} grbl_stream_t;
 
 #define DECL_GRBL_STREAM(name, getc_cb, available_cb, clear_cb, putc_cb, flush_cb) grbl_stream_t name = {getc_cb, available_cb, clear_cb, putc_cb, flush_cb, NULL}
@@ -66,6 +113,11 @@ extern "C"
 	void grbl_stream_eeprom(uint16_t address);
 
 	void grbl_stream_start_broadcast(void);
+	void grbl_stream_start_unicast(grbl_stream_t *stream);
+#ifdef ENABLE_STREAM_TX_QUEUE
+	void grbl_stream_mark_status(void);
+	void grbl_stream_tx_flush(void);
+#endif
 	void grbl_stream_putc(char c);
 	void grbl_stream_printf(const char *fmt, ...);
 	void grbl_stream_overflow(uint8_t c);
@@ -83,6 +135,26 @@ extern "C"
 	uint8_t grbl_stream_write_available(void);
 	uint8_t grbl_stream_busy(void);
 
+#ifdef ENABLE_STATUS_ROUTING
+	bool grbl_stream_status_broadcast(void);
+#endif
+#ifdef ENABLE_STATUS_PUSH
+	void grbl_stream_status_subscribe(uint16_t interval, bool on_change);
+	bool grbl_stream_status_push_due(void);
+	bool grbl_stream_status_push_start(uint32_t hash);
+#endif
+#ifdef ENABLE_STATUS_COMPACT
+	void grbl_stream_status_compact(bool enable);
+	grbl_stream_t *grbl_stream_status_compact_next(grbl_stream_t *stream);
+#endif
+#ifdef ENABLE_STREAM_WINDOW
+	void grbl_stream_window(uint8_t ack_lines);
+	bool grbl_stream_window_active(void);
+	bool grbl_stream_window_crlf(void);
+	grbl_stream_t *grbl_stream_window_line(bool force);
+	grbl_stream_t *grbl_stream_window_next(grbl_stream_t *stream);
+#endif
+
 #ifdef ENABLE_DEBUG_STREAM
 	// to customize the debug stream you can reference it to an existing stream
 	// for example to set it to the USB stream you can define DEBUG_STREAM like this
@@ -29,6 +29,7 @@
 #include "modules/softuart.h"
 #include "modules/system_languages.h"
 #include "modules/system_menu.h"
+#include "modules/ramfs.h"
 
 uint8_t g_module_lockguard;
 /**
@@ -74,9 +75,62 @@ void mod_init(void)
 	LOAD_MODULE(file_system);
 #endif
 
+#ifdef ENABLE_RAMFS
+	LOAD_MODULE(ramfs);
+#endif
+
 	load_modules();
 }
 
+#ifdef ENABLE_MODULE_PROFILING
+static mod_profile_t *mod_profiles;
+
+bool mod_profile_call(mod_profile_t *profile, bool (*fptr)(void *), void *args)
+{
+	uint32_t start = mcu_micros();
+	bool result = fptr(args);
+	uint32_t elapsed = mcu_micros() - start;
+	profile->calls++;
+	profile->time += elapsed;
+	if (profile->max_time < elapsed)
+	{
+		profile->max_time = elapsed;
+	}
+	return result;
+}
+
+void mod_profile_add(mod_profile_t *profile)
+{
+	mod_profile_t *p = mod_profiles;
+	while (p != NULL)
+	{
+		// already added
+		if (p == profile)
+		{
+			return;
+		}
+		p = p->next;
+	}
+
+	profile->next = mod_profiles;
+	mod_profiles = profile;
+}
+
+// prints and resets the counters of all listeners
+void mod_profile_report(void)
+{
+	mod_profile_t *p = mod_profiles;
+	while (p != NULL)
+	{
+		proto_info("%s.%s - %lu calls, %luus, max %luus", p->event, p->listener, p->calls, p->time, p->max_time);
+		p->calls = 0;
+		p->time = 0;
+		p->max_time = 0;
+		p = p->next;
+	}
+}
+#endif
+
 #ifdef MODULE_DEBUG_ENABLED
 bool mod_event_default_handler(mod_delegate_event_t **event, mod_delegate_event_t **last, void **args)
 {
@@ -91,7 +145,7 @@ bool mod_event_default_handler(mod_delegate_event_t **event, mod_delegate_event_
 		if (ptr->fptr != NULL && !CHECKFLAG(ptr->fplock, (g_module_lockguard | LISTENER_RUNNING_LOCK)))
 		{
 			SETFLAG(ptr->fplock, LISTENER_RUNNING_LOCK);
-			if (ptr->fptr(*args))
+			if (EVENT_LISTENER_CALL(ptr, *args))
 			{
 				CLEARFLAG(ptr->fplock, LISTENER_RUNNING_LOCK);
 				*last = *event; /*handled. restart.*/
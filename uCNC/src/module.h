@@ -55,6 +55,31 @@ extern "C"
 	extern void name##_init(void); \
 	name##_init()
 
+#ifdef ENABLE_MODULE_PROFILING
+	// listener run time counters
+	typedef struct mod_profile_
+	{
+		const char *event;
+		const char *listener;
+		uint32_t calls;
+		uint32_t time;	   // us
+		uint32_t max_time; // us
+		struct mod_profile_ *next;
+	} mod_profile_t;
+	bool mod_profile_call(mod_profile_t *profile, bool (*fptr)(void *), void *args);
+	void mod_profile_add(mod_profile_t *profile);
+	void mod_profile_report(void);
+#define EVENT_PROFILE mod_profile_t profile;
+#define EVENT_PROFILE_INIT(name, handler) , {#name, #handler, 0, 0, 0, NULL}
+#define EVENT_PROFILE_ADD(listener) mod_profile_add(&(listener)->profile)
+#define EVENT_LISTENER_CALL(ptr, args) mod_profile_call(&(ptr)->profile, (ptr)->fptr, args)
+#else
+#define EVENT_PROFILE
+#define EVENT_PROFILE_INIT(name, handler)
+#define EVENT_PROFILE_ADD(listener)
+#define EVENT_LISTENER_CALL(ptr, args) (ptr)->fptr(args)
+#endif
+
 // definitions to create events and event listeners
 #define EVENT(name)                          \
 	typedef struct name##_delegate_event_    \
@@ -62,12 +87,13 @@ extern "C"
 		name##_delegate fptr;                \
 		uint8_t fplock;                      \
 		struct name##_delegate_event_ *next; \
+		EVENT_PROFILE                        \
 	} name##_delegate_event_t;               \
 	extern name##_delegate_event_t *
 #define EVENT_HANDLER_NAME(name) event_##name##_handler
 #define EVENT_INVOKE(name, args) EVENT_HANDLER_NAME(name)(args)
-#define CREATE_EVENT_LISTENER(name, handler) __attribute__((used)) name##_delegate_event_t name##_delegate_##handler = {&handler, LISTENER_NO_LOCK, NULL}
-#define CREATE_EVENT_LISTENER_WITHLOCK(name, handler, lock_flags) __attribute__((used)) name##_delegate_event_t name##_delegate_##handler = {&handler, (lock_flags & (~LISTENER_RUNNING_LOCK)), NULL}
+#define CREATE_EVENT_LISTENER(name, handler) __attribute__((used)) name##_delegate_event_t name##_delegate_##handler = {&handler, LISTENER_NO_LOCK, NULL EVENT_PROFILE_INIT(name, handler)}
+#define CREATE_EVENT_LISTENER_WITHLOCK(name, handler, lock_flags) __attribute__((used)) name##_delegate_event_t name##_delegate_##handler = {&handler, (lock_flags & (~LISTENER_RUNNING_LOCK)), NULL EVENT_PROFILE_INIT(name, handler)}
 #define ADD_EVENT_LISTENER(name, handler)                         \
 	{                                                             \
 		extern name##_delegate_event_t name##_delegate_##handler; \
@@ -86,6 +112,7 @@ extern "C"
 			p->next = &name##_delegate_##handler;                 \
 			p->next->next = NULL;                                 \
 		}                                                         \
+		EVENT_PROFILE_ADD(&name##_delegate_##handler);            \
 	}
 
 	// definitions to create overridable default handlers for functions with a declaration like uint8_t (*function)(void *, bool *);
@@ -118,7 +145,7 @@ extern "C"
 			if (ptr->fptr != NULL && !CHECKFLAG(ptr->fplock, (g_module_lockguard | LISTENER_RUNNING_LOCK))) \
 			{                                                                                               \
 				SETFLAG(ptr->fplock, LISTENER_RUNNING_LOCK);                                                \
-				if (ptr->fptr(args))                                                                        \
+				if (EVENT_LISTENER_CALL(ptr, args))                                                         \
 				{                                                                                           \
 					CLEARFLAG(ptr->fplock, LISTENER_RUNNING_LOCK);                                          \
 					start = name##_event; /*handled. restart.*/                                             \
@@ -137,6 +164,7 @@ typedef struct mod_delegate_event_
 	mod_delegate fptr;
 	uint8_t fplock;
 	struct mod_delegate_event_ *next;
+	EVENT_PROFILE
 } mod_delegate_event_t;
 
 bool mod_event_default_handler(mod_delegate_event_t **event, mod_delegate_event_t **last, void **args);
@@ -224,53 +224,1009 @@ static fs_file_t *fs_path_parse(fs_file_info_t *current_path, const char *new_pa
 	return NULL;
 }
 
-#ifdef ENABLE_MAIN_LOOP_MODULES
-DECL_BUFFER(uint8_t, fs_file_buffer, RX_BUFFER_SIZE);
+#ifndef FS_READAHEAD_SIZE
+#define FS_READAHEAD_SIZE 512
+#endif
+
+// running file read-ahead double buffer
+// the parser consumes one buffer while the other is refilled in (sector sized) chunks
+static uint8_t fs_readahead_buffer[2][FS_READAHEAD_SIZE];
+static uint16_t fs_readahead_len[2];
+static uint16_t fs_readahead_pos;
+static uint8_t fs_readahead_index;
+
+static void running_file_fill(void)
+{
+	// the current buffer is only empty if both are drained so fill it first
+	uint8_t b = fs_readahead_index;
+	for (uint8_t i = 0; i < 2; i++, b ^= 1)
+	{
+		if (!fs_running_file)
+		{
+			return;
+		}
+
+		if (!fs_readahead_len[b])
+		{
+			size_t read = fs_read(fs_running_file, fs_readahead_buffer[b], FS_READAHEAD_SIZE);
+			fs_readahead_len[b] = (uint16_t)read;
+			// auto close file
+			if (read < FS_READAHEAD_SIZE || !fs_available(fs_running_file))
+			{
+				fs_close(fs_running_file);
+				fs_running_file = NULL;
+			}
+		}
+	}
+}
+
+static void running_file_start(fs_file_t *fp)
+{
+	fs_readahead_len[0] = 0;
+	fs_readahead_len[1] = 0;
+	fs_readahead_pos = 0;
+	fs_readahead_index = 0;
+	fs_running_file = fp;
+	// prefill both buffers
+	running_file_fill();
+}
+
+#ifndef FS_LINE_INDEX_STEP
+#define FS_LINE_INDEX_STEP 1000
+#endif
+#define FS_LINE_INDEX_EXT ".idx"
+
+#ifndef FS_JOURNAL_PERIOD_MS
+#define FS_JOURNAL_PERIOD_MS 5000
+#endif
+// expected time (us) of a journal write (the main loop scheduler budget)
+#ifndef FS_JOURNAL_WRITE_US
+#define FS_JOURNAL_WRITE_US 2000
+#endif
+// the job journal resumes from the line index
+#if (defined(ENABLE_FS_JOB_JOURNAL) && (FS_LINE_INDEX_STEP > 0) && (FS_JOURNAL_PERIOD_MS > 0))
+#define FS_ENABLE_JOURNAL
+#define FS_JOURNAL_FILE "job.jnl"
+#endif
+
+#if (FS_LINE_INDEX_STEP > 0)
+#define FS_LINE_INDEX_MAGIC 0x58444955UL
+
+/**
+ * Line index file (<file>.idx)
+ * A header followed by a checkpoint every FS_LINE_INDEX_STEP lines
+ * Each checkpoint holds the byte offset of the line and the parser modal state before executing it
+ * */
+typedef struct fs_line_index_header_
+{
+	uint32_t magic;
+	uint32_t size;
+	uint32_t timestamp;
+	uint32_t step;
+} fs_line_index_header_t;
+
+typedef struct fs_line_index_
+{
+	uint32_t line;
+	uint32_t offset;
+	uint8_t modalgroups[MAX_MODAL_GROUPS];
+	uint16_t feed;
+	uint16_t spindle;
+} fs_line_index_t;
+
+static char fs_line_index_path[FS_PATH_NAME_MAX_LEN];
+static bool fs_line_index_active;
+static uint32_t fs_line_index_line;
+static uint32_t fs_line_index_offset;
+static bool fs_line_index_eol;
+
+static void fs_line_index_close(void)
+{
+	fs_line_index_active = false;
+}
+
+// reopened on every write so that the index survives a power loss
+static void fs_line_index_write(const void *data, size_t len, const char *mode)
+{
+	fs_file_t *fp = fs_path_parse(&fs_cwd, fs_line_index_path, mode);
+	if (fp)
+	{
+		if (fs_write(fp, (const uint8_t *)data, len) == len)
+		{
+			fs_close(fp);
+			return;
+		}
+		fs_close(fp);
+	}
+
+	fs_line_index_close();
+}
+
+static void fs_line_index_start(const char *idxpath, fs_file_t *fp)
+{
+	fs_line_index_header_t header = {FS_LINE_INDEX_MAGIC, fp->file_info.size, fp->file_info.timestamp, FS_LINE_INDEX_STEP};
+	memcpy(fs_line_index_path, idxpath, FS_PATH_NAME_MAX_LEN);
+	fs_line_index_active = true;
+	fs_line_index_line = 0;
+	fs_line_index_offset = 0;
+	// force a checkpoint on line 1
+	fs_line_index_eol = true;
+	fs_line_index_write(&header, sizeof(header), "w");
+}
+
+// tracks the read position and stores a checkpoint when the parser requests the first char of an indexed line
+// at that point the previous line has been fully executed by the parser
+static void fs_line_index_update(uint8_t c)
+{
+	if (fs_line_index_eol)
+	{
+		fs_line_index_eol = false;
+		if (!(fs_line_index_line % FS_LINE_INDEX_STEP))
+		{
+			fs_line_index_t cp;
+			memset(&cp, 0, sizeof(cp));
+			cp.line = fs_line_index_line + 1;
+			cp.offset = fs_line_index_offset;
+			parser_get_modes(cp.modalgroups, &cp.feed, &cp.spindle);
+			fs_line_index_write(&cp, sizeof(cp), "a");
+		}
+	}
+
+	fs_line_index_offset++;
+	if (c == '\n')
+	{
+		fs_line_index_line++;
+		fs_line_index_eol = true;
+	}
+}
+
+// finds the nearest checkpoint before the line
+static bool fs_line_index_find(const char *idxpath, fs_file_t *fp, uint32_t line, fs_line_index_t *cp)
+{
+	bool found = false;
+	fs_file_t *idx = fs_path_parse(&fs_cwd, idxpath, "r");
+	if (!idx)
+	{
+		return false;
+	}
+
+	fs_line_index_header_t header;
+	if (fs_read(idx, (uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+			header.magic == FS_LINE_INDEX_MAGIC && header.size == fp->file_info.size && header.timestamp == fp->file_info.timestamp)
+	{
+		fs_line_index_t next;
+		while (fs_read(idx, (uint8_t *)&next, sizeof(next)) == sizeof(next) && next.line <= line)
+		{
+			memcpy(cp, &next, sizeof(next));
+			found = true;
+		}
+	}
+
+	fs_close(idx);
+	return found;
+}
+
+// gcode lines injected in the running file stream to restore the modal state
+static char fs_resume_modes[256];
+static uint8_t fs_resume_modes_pos;
+// line to resume from while catching up (in check mode) from the checkpoint
+static uint32_t fs_resume_line;
+static bool fs_resume_checkmode;
+// line number at the running file read position
+static uint32_t fs_running_line;
+static bool fs_running_eol;
+#ifdef FS_ENABLE_JOURNAL
+// move back to the start of the resumed line
+static bool fs_resume_return;
+#endif
+
+static size_t fs_resume_append_tools(char *line, size_t n, size_t len, uint8_t *modes, uint16_t spindle)
+{
+#if TOOL_COUNT > 0
+	n += str_snprintf(&line[n], len - n, "M%d S%d ", modes[8], spindle);
+#ifdef ENABLE_COOLANT
+#ifndef M7_SAME_AS_M8
+	if (modes[9] & M7)
+	{
+		n += str_snprintf(&line[n], len - n, "M%d ", 7);
+	}
+#endif
+	if (modes[9] & M8)
+	{
+		n += str_snprintf(&line[n], len - n, "M%d ", 8);
+	}
+#endif
+#endif
+	return n;
+}
+
+// the formatted writes never go beyond len so a full buffer means the lines were truncated
+static bool fs_resume_append_modes(size_t n, uint8_t *modes, uint16_t feed, uint16_t spindle)
+{
+	char *line = fs_resume_modes;
+	size_t len = sizeof(fs_resume_modes) - 1;
+	// the feed is stored in mm
+	n += str_snprintf(&line[n], len - n, "G21 F%d\n", feed);
+	n += str_snprintf(&line[n], len - n, "G%d G%d G%d G%d G%d ", modes[1], modes[2], modes[3], modes[4], modes[6]);
+	n += str_snprintf(&line[n], len - n, (modes[7] == 62) ? "G61.1 " : "G%d ", modes[7]);
+	// only linear motion modes can be set without axis words
+	if (modes[0] <= 1 && !modes[12])
+	{
+		n += str_snprintf(&line[n], len - n, "G%d ", modes[0]);
+	}
+	n = fs_resume_append_tools(line, n, len, modes, spindle);
+	if (n >= len)
+	{
+		return false;
+	}
+	line[n] = '\n';
+	return true;
+}
+
+static bool fs_resume_set_modes(uint8_t *modes, uint16_t feed, uint16_t spindle)
+{
+	memset(fs_resume_modes, 0, sizeof(fs_resume_modes));
+	fs_resume_modes_pos = 0;
+	return fs_resume_append_modes(0, modes, feed, spindle);
+}
+
+#ifdef FS_ENABLE_JOURNAL
+// travels to the start of the line at the current height, starts the tools and plunges at the line feed
+static size_t fs_resume_append_return(size_t n, float *target, uint8_t *modes, uint16_t feed, uint16_t spindle)
+{
+	const char axis_letter[] = "XYZABC";
+	char *line = fs_resume_modes;
+	size_t len = sizeof(fs_resume_modes) - 1;
+	n += str_snprintf(&line[n], len - n, "G21 G90 G94 G53 G%d", 0);
+	for (uint8_t i = 0; i < AXIS_COUNT; i++)
+	{
+#ifdef AXIS_Z
+		if (i == AXIS_Z)
+		{
+			continue;
+		}
+#endif
+		n += str_snprintf(&line[n], len - n, " %c%f", axis_letter[i], target[i]);
+	}
+	n += str_snprintf(&line[n], len - n, "%c", '\n');
+#if TOOL_COUNT > 0
+	n = fs_resume_append_tools(line, n, len, modes, spindle);
+	n += str_snprintf(&line[n], len - n, "%c", '\n');
+#endif
+#ifdef AXIS_Z
+	n += str_snprintf(&line[n], len - n, (feed) ? "G53 G1 Z%f F%d\n" : "G53 G0 Z%f\n", target[AXIS_Z], feed);
+#endif
+	return n;
+}
+#endif
+
+// the parser reached the resume line
+static void fs_resume_end(void)
+{
+	uint8_t modalgroups[MAX_MODAL_GROUPS];
+	uint16_t feed;
+	uint16_t spindle;
+	size_t n = 0;
+#ifdef FS_ENABLE_JOURNAL
+	float target[AXIS_COUNT];
+	bool move = false;
+#endif
+
+	fs_resume_line = 0;
+	if (fs_resume_checkmode)
+	{
+#ifdef FS_ENABLE_JOURNAL
+		// the parser position is the start of the resumed line
+		parser_get_coordsys(253, target);
+		move = fs_resume_return;
+#endif
+		fs_resume_checkmode = false;
+		mc_toogle_checkmode();
+		// the machine did not move while catching up
+		mc_sync_position();
+	}
+
+	// the tools were not updated in check mode
+	parser_get_modes(modalgroups, &feed, &spindle);
+	memset(fs_resume_modes, 0, sizeof(fs_resume_modes));
+	fs_resume_modes_pos = 0;
+#if TOOL_COUNT > 0
+	// the parser only updates the tools on a state change
+#ifdef ENABLE_COOLANT
+	n = str_snprintf(fs_resume_modes, sizeof(fs_resume_modes) - 1, "M5 M%d\n", 9);
+#else
+	n = str_snprintf(fs_resume_modes, sizeof(fs_resume_modes) - 1, "M%d\n", 5);
+#endif
+#endif
+#ifdef FS_ENABLE_JOURNAL
+	if (move)
+	{
+		n = fs_resume_append_return(n, target, modalgroups, feed, spindle);
+	}
+#endif
+	if (!fs_resume_append_modes(n, modalgroups, feed, spindle))
+	{
+		// never runs truncated lines
+		memset(fs_resume_modes, 0, sizeof(fs_resume_modes));
+		proto_info("Resume failed");
+		cnc_alarm(EXEC_ALARM_SOFTRESET);
+	}
+}
+#endif
+
+#ifdef FS_ENABLE_JOURNAL
+/**
+ * Job journal (/<default drive>/job.jnl)
+ * A start record with the running file path, followed by the executing line
+ * appended every FS_JOURNAL_PERIOD_MS and a done record when the file is fully parsed
+ * */
+#define FS_JOURNAL_START 1
+#define FS_JOURNAL_POINT 2
+#define FS_JOURNAL_DONE 3
+
+typedef struct fs_journal_record_
+{
+	uint32_t type;
+	uint32_t line;
+} fs_journal_record_t;
+
+static bool fs_journal_active;
+static uint32_t fs_journal_line;
+static uint32_t fs_journal_next;
+
+static fs_file_t *fs_journal_open(const char *mode)
+{
+	char path[sizeof(FS_JOURNAL_FILE) + 3];
+
+	if (!fs_default_drive)
+	{
+		return NULL;
+	}
+
+	path[0] = '/';
+	path[1] = fs_default_drive->drive;
+	path[2] = '/';
+	path[3] = 0;
+	strcat(path, FS_JOURNAL_FILE);
+	return fs_path_parse(NULL, path, mode);
+}
+
+static void fs_journal_append(uint32_t type, uint32_t line, const char *path)
+{
+	fs_journal_record_t record;
+
+	record.type = type;
+	record.line = line;
+
+	// reopened on every append so that each record is committed to the media
+	fs_file_t *fp = fs_journal_open((type == FS_JOURNAL_START) ? "w" : "a");
+	if (!fp)
+	{
+		fs_journal_active = false;
+		return;
+	}
+
+	bool ok = (fs_write(fp, (const uint8_t *)&record, sizeof(record)) == sizeof(record));
+	if (ok && path)
+	{
+		ok = (fs_write(fp, (const uint8_t *)path, FS_PATH_NAME_MAX_LEN) == FS_PATH_NAME_MAX_LEN);
+	}
+	fs_close(fp);
+
+	if (!ok)
+	{
+		// a partial record ends the journal and the job can't be resumed past the last good record
+		fs_journal_active = false;
+		proto_info("Job journal write failed");
+	}
+}
+
+static void fs_journal_start(const char *path)
+{
+	fs_journal_active = true;
+	fs_journal_line = 0;
+	fs_journal_next = mcu_millis() + FS_JOURNAL_PERIOD_MS;
+	fs_journal_append(FS_JOURNAL_START, 0, path);
+}
+
+static void fs_journal_end(void)
+{
+	if (fs_journal_active)
+	{
+		fs_journal_active = false;
+		fs_journal_append(FS_JOURNAL_DONE, 0, NULL);
+	}
+}
+#endif
+
+// the running file is the token cache of the source file
+static bool fs_token_cache_replay;
+
+#ifdef ENABLE_FS_TOKEN_CACHE
+#ifndef FS_TOKEN_CACHE_LINE_SIZE
+#define FS_TOKEN_CACHE_LINE_SIZE 128
+#endif
+#ifndef FS_TOKEN_CACHE_BUFFER_SIZE
+#define FS_TOKEN_CACHE_BUFFER_SIZE 512
+#endif
+#define FS_TOKEN_CACHE_EXT ".ucb"
+#define FS_TOKEN_CACHE_MAGIC 0x31425543UL
+// a complete cache ends with this (harmless) comment line
+#define FS_TOKEN_CACHE_FOOTER ";ucb\n"
+#define FS_TOKEN_CACHE_FOOTER_LEN (sizeof(FS_TOKEN_CACHE_FOOTER) - 1)
+// a word is stored as a head byte with the letter and the value format followed by the value in groups of 7 bits
+// all bytes have the MSB set so a pre-tokenized line is safely discarded like any text line
+// small integers (like G1 or M3) take 2 bytes, values with short float mantissas 4 and all others 6
+#define FS_TOKEN_INT 0x00
+#define FS_TOKEN_SHORT 0x20
+#define FS_TOKEN_FLOAT 0x40
+#define FS_TOKEN_FORMAT_MASK 0x60
+#define FS_TOKEN_LETTER_MASK 0x1F
+#define FS_TOKEN_MAX_SIZE 6
+
+/**
+ * Token cache file (<file>.ucb)
+ * A header with the source file size and timestamp followed by every source line
+ * Lines with words only are stored pre-tokenized and all other lines as text
+ * */
+typedef struct fs_token_cache_header_
+{
+	uint32_t magic;
+	uint32_t size;
+	uint32_t timestamp;
+} fs_token_cache_header_t;
+
+static char fs_token_cache_path[FS_PATH_NAME_MAX_LEN];
+static bool fs_token_cache_active;
+static uint8_t fs_token_cache_buffer[FS_TOKEN_CACHE_BUFFER_SIZE];
+static uint16_t fs_token_cache_len;
+// line being recorded as read from the file and as lexed by the parser
+static uint8_t fs_token_cache_line[FS_TOKEN_CACHE_LINE_SIZE];
+static uint16_t fs_token_cache_line_len;
+static uint8_t fs_token_cache_tokens[FS_TOKEN_CACHE_LINE_SIZE];
+static uint16_t fs_token_cache_tokens_len;
+static bool fs_token_cache_words_only;
+static bool fs_token_cache_cr;
+// the parser lexed the end of the line
+static bool fs_token_cache_lexed;
+// the line feed was read from the file (the parser might still be lexing the last word)
+static bool fs_token_cache_eol;
+
+static void fs_token_cache_set_path(const char *path)
+{
+	memset(fs_token_cache_path, 0, FS_PATH_NAME_MAX_LEN);
+	strncpy(fs_token_cache_path, path, FS_PATH_NAME_MAX_LEN - sizeof(FS_TOKEN_CACHE_EXT));
+	strcat(fs_token_cache_path, FS_TOKEN_CACHE_EXT);
+}
+
+static void fs_token_cache_abort(void)
+{
+	if (fs_token_cache_active)
+	{
+		fs_token_cache_active = false;
+		fs_remove(fs_token_cache_path);
+	}
+}
+
+// reopened on every flush like the line index so both can be written on single writer drives
+static void fs_token_cache_flush(void)
+{
+	if (!fs_token_cache_len)
+	{
+		return;
+	}
+
+	fs_file_t *fp = fs_path_parse(NULL, fs_token_cache_path, "a");
+	if (fp)
+	{
+		size_t written = fs_write(fp, fs_token_cache_buffer, fs_token_cache_len);
+		fs_close(fp);
+		if (written == fs_token_cache_len)
+		{
+			fs_token_cache_len = 0;
+			return;
+		}
+	}
+
+	fs_token_cache_abort();
+}
+
+static void fs_token_cache_write(const uint8_t *data, uint16_t len)
+{
+	while (len && fs_token_cache_active)
+	{
+		uint16_t n = MIN(len, FS_TOKEN_CACHE_BUFFER_SIZE - fs_token_cache_len);
+		memcpy(&fs_token_cache_buffer[fs_token_cache_len], data, n);
+		fs_token_cache_len += n;
+		data += n;
+		len -= n;
+		if (fs_token_cache_len == FS_TOKEN_CACHE_BUFFER_SIZE)
+		{
+			fs_token_cache_flush();
+		}
+	}
+}
+
+static void fs_token_cache_line_reset(void)
+{
+	fs_token_cache_line_len = 0;
+	fs_token_cache_tokens_len = 0;
+	fs_token_cache_words_only = true;
+	fs_token_cache_cr = false;
+	fs_token_cache_lexed = false;
+	fs_token_cache_eol = false;
+}
+
+static void fs_token_cache_line_end(void)
+{
+	// the parser must have lexed the whole line without errors
+	if (fs_token_cache_words_only && fs_token_cache_lexed && fs_token_cache_tokens_len)
+	{
+		fs_token_cache_tokens[fs_token_cache_tokens_len++] = '\n';
+		fs_token_cache_write(fs_token_cache_tokens, fs_token_cache_tokens_len);
+	}
+	else
+	{
+		fs_token_cache_write(fs_token_cache_line, fs_token_cache_line_len);
+	}
+
+	fs_token_cache_line_reset();
+}
+
+static void fs_token_cache_start(const char *path, fs_file_t *fp)
+{
+	fs_token_cache_header_t header = {FS_TOKEN_CACHE_MAGIC, fp->file_info.size, fp->file_info.timestamp};
+	fs_token_cache_set_path(path);
+	fs_token_cache_line_reset();
+	fs_token_cache_len = 0;
+	fs_file_t *ucb = fs_path_parse(NULL, fs_token_cache_path, "w");
+	if (ucb)
+	{
+		fs_token_cache_active = (fs_write(ucb, (const uint8_t *)&header, sizeof(header)) == sizeof(header));
+		fs_close(ucb);
+	}
+}
+
+// the running file ended
+static void fs_token_cache_end(void)
+{
+	if (fs_token_cache_active)
+	{
+		if (fs_token_cache_line_len)
+		{
+			fs_token_cache_line_end();
+		}
+		fs_token_cache_write((const uint8_t *)FS_TOKEN_CACHE_FOOTER, FS_TOKEN_CACHE_FOOTER_LEN);
+		fs_token_cache_flush();
+		fs_token_cache_active = false;
+	}
+}
+
+// tracks the file chars of the line being recorded
+// the line is only stored when the next line starts since the parser reads the line feed before the last word is lexed
+static void fs_token_cache_putc(uint8_t c)
+{
+	if (fs_token_cache_eol)
+	{
+		fs_token_cache_line_end();
+	}
+
+	if (fs_token_cache_line_len >= FS_TOKEN_CACHE_LINE_SIZE)
+	{
+		fs_token_cache_abort();
+		return;
+	}
+
+	fs_token_cache_line[fs_token_cache_line_len++] = c;
+	if (c == '\n')
+	{
+		fs_token_cache_eol = true;
+		return;
+	}
+
+	// anything after a CR would be a new line to the parser
+	if (fs_token_cache_cr)
+	{
+		fs_token_cache_words_only = false;
+	}
+
+	c = TOUPPER(c);
+	switch (c)
+	{
+	case '\r':
+		fs_token_cache_cr = true;
+		break;
+	case ' ':
+	case '\t':
+	case '.':
+	case '-':
+	case '+':
+		break;
+#ifdef ENABLE_O_CODES
+	// flow control
+	case 'O':
+		fs_token_cache_words_only = false;
+		break;
+#endif
+	default:
+		// comments, expressions, parameters and grbl commands stay as text
+		if (!(c >= 'A' && c <= 'Z') && !(c >= '0' && c <= '9'))
+		{
+			fs_token_cache_words_only = false;
+		}
+		break;
+	}
+}
+
+static void fs_token_cache_encode(uint8_t word, float value)
+{
+	uint32_t bits;
+	uint8_t *token = &fs_token_cache_tokens[fs_token_cache_tokens_len];
+	uint8_t groups = 5;
+	uint8_t shift = 0;
+	uint8_t format = FS_TOKEN_FLOAT;
+
+	memcpy(&bits, &value, sizeof(uint32_t));
+	if (value >= 0 && value < 128)
+	{
+		uint8_t i = (uint8_t)value;
+		float small = (float)i;
+		// the exact same float bits are replayed (not -0)
+		if (!memcmp(&small, &value, sizeof(float)))
+		{
+			format = FS_TOKEN_INT;
+			bits = i;
+			groups = 1;
+		}
+	}
+
+	if (format == FS_TOKEN_FLOAT && !(bits & 0x7FF))
+	{
+		format = FS_TOKEN_SHORT;
+		shift = 11;
+		groups = 3;
+	}
+
+	*token++ = 0x80 | format | (word - 'A');
+	bits >>= shift;
+	while (groups--)
+	{
+		*token++ = 0x80 | (uint8_t)(bits & 0x7F);
+		bits >>= 7;
+	}
+
+	fs_token_cache_tokens_len = (uint16_t)(token - fs_token_cache_tokens);
+}
+
+// records the words lexed by the parser
+bool fs_token_cache_record(void *args)
+{
+	if (fs_token_cache_active)
+	{
+		parser_token_args_t *ptr = (parser_token_args_t *)args;
+		if (*(ptr->word) == EOL)
+		{
+			// the end of the line is marked by the parser (a CR+LF is lexed twice)
+			fs_token_cache_lexed = true;
+		}
+		else if (fs_token_cache_lexed)
+		{
+			fs_token_cache_words_only = false;
+		}
+		// keeps room for the line feed
+		else if ((fs_token_cache_tokens_len + FS_TOKEN_MAX_SIZE) < FS_TOKEN_CACHE_LINE_SIZE)
+		{
+			fs_token_cache_encode(*(ptr->word), *(ptr->value));
+		}
+		else
+		{
+			fs_token_cache_words_only = false;
+		}
+	}
+
+	return EVENT_CONTINUE;
+}
+CREATE_EVENT_LISTENER(parse_token_lexed, fs_token_cache_record);
+
+// feeds the pre-tokenized words to the parser
+bool fs_token_cache_fetch(void *args)
+{
+	if (fs_token_cache_replay)
+	{
+		uint8_t c = (uint8_t)grbl_stream_peek();
+		if (c & 0x80)
+		{
+			parser_token_args_t *ptr = (parser_token_args_t *)args;
+			uint32_t bits = 0;
+			uint8_t groups = 5;
+			uint8_t shift = 0;
+			grbl_stream_getc();
+			*(ptr->word) = 'A' + (c & FS_TOKEN_LETTER_MASK);
+			switch (c & FS_TOKEN_FORMAT_MASK)
+			{
+			case FS_TOKEN_INT:
+				*(ptr->value) = (float)((uint8_t)grbl_stream_getc() & 0x7F);
+				return EVENT_HANDLED;
+			case FS_TOKEN_SHORT:
+				groups = 3;
+				shift = 11;
+				break;
+			}
+			for (uint8_t i = 0; i < (groups * 7); i += 7)
+			{
+				bits |= ((uint32_t)((uint8_t)grbl_stream_getc() & 0x7F)) << i;
+			}
+			bits <<= shift;
+			memcpy(ptr->value, &bits, sizeof(uint32_t));
+			return EVENT_HANDLED;
+		}
+	}
+
+	return EVENT_CONTINUE;
+}
+CREATE_EVENT_LISTENER(parse_token_fetch, fs_token_cache_fetch);
+
+// opens the token cache of the source file if it's complete and up to date
+static fs_file_t *fs_token_cache_open(const char *path, fs_file_t *src)
+{
+	fs_token_cache_header_t header;
+	char footer[FS_TOKEN_CACHE_FOOTER_LEN];
+	fs_token_cache_set_path(path);
+	fs_file_t *fp = fs_path_parse(NULL, fs_token_cache_path, "r");
+	if (!fp)
+	{
+		return NULL;
+	}
+
+	if (fp->file_info.size >= (sizeof(header) + FS_TOKEN_CACHE_FOOTER_LEN) &&
+			fs_read(fp, (uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+			header.magic == FS_TOKEN_CACHE_MAGIC && header.size == src->file_info.size && header.timestamp == src->file_info.timestamp &&
+			fs_seek(fp, fp->file_info.size - FS_TOKEN_CACHE_FOOTER_LEN) &&
+			fs_read(fp, (uint8_t *)footer, FS_TOKEN_CACHE_FOOTER_LEN) == FS_TOKEN_CACHE_FOOTER_LEN &&
+			!memcmp(footer, FS_TOKEN_CACHE_FOOTER, FS_TOKEN_CACHE_FOOTER_LEN) &&
+			fs_seek(fp, sizeof(header)))
+	{
+		return fp;
+	}
+
+	fs_close(fp);
+	return NULL;
+}
+#endif
+
+// positions the file at the start of the line (1 based)
+// with a line index it seeks the nearest checkpoint and restores its modal state
+// the lines between the checkpoint and the requested line are then parsed in check mode
+// catchup forces this (from the file start if there is no index) to recover the line start position
+static bool fs_file_seek_line(fs_file_t *fp, const char *idxpath, uint32_t line, bool catchup)
+{
+	uint32_t current = 1;
+	uint32_t offset = 0;
+#if (FS_LINE_INDEX_STEP > 0)
+	fs_line_index_t cp;
+	memset(fs_resume_modes, 0, sizeof(fs_resume_modes));
+	fs_resume_modes_pos = 0;
+	fs_resume_line = 0;
+	fs_running_eol = false;
+	bool indexed = (line > 1) && fs_line_index_find(idxpath, fp, (catchup) ? (line - 1) : line, &cp) && fs_seek(fp, cp.offset);
+	if (indexed)
+	{
+		if (!fs_resume_set_modes(cp.modalgroups, cp.feed, cp.spindle))
+		{
+			return false;
+		}
+		current = cp.line;
+	}
+
+	fs_running_line = current;
+	if ((indexed || catchup) && current < line)
+	{
+		fs_resume_line = line;
+		fs_resume_checkmode = !mc_get_checkmode();
+		if (fs_resume_checkmode)
+		{
+			mc_toogle_checkmode();
+		}
+		return true;
+	}
+
+	if (indexed)
+	{
+		return true;
+	}
+
+	fs_running_line = line;
+#endif
+
+	// skip the lines in bulk
+	// the read-ahead buffer is not in use yet
+	while (current < line)
+	{
+		size_t read = fs_read(fp, fs_readahead_buffer[0], FS_READAHEAD_SIZE);
+		if (!read)
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < read; i++)
+		{
+			offset++;
+			if (fs_readahead_buffer[0][i] == '\n' && (++current == line))
+			{
+				break;
+			}
+		}
+	}
+
+	return fs_seek(fp, offset);
+}
+
+// the running file is a job estimate
+static bool fs_estimate_file;
+
+#ifdef ENABLE_JOB_ESTIMATOR
+// the motions are parsed in check mode and the planner blocks are timed instead of executed
+static void fs_estimate_start(void)
+{
+	if (!mc_get_checkmode())
+	{
+		mc_toogle_checkmode();
+	}
+	itp_estimate_start();
+}
+
+// reports the estimate and leaves check mode the same way $C does
+static void fs_estimate_end(void)
+{
+	itp_estimate_t estimate;
+	fs_estimate_file = false;
+	itp_estimate_stop(&estimate);
+	proto_info("Estimated time - %fs", estimate.time);
+	proto_info("Max feed - %f", estimate.max_feed);
+#if TOOL_COUNT > 1
+	for (uint8_t i = 0; i <= TOOL_COUNT; i++)
+	{
+		if (estimate.tool_time[i] > 0)
+		{
+			proto_info("Tool %hd time - %fs", i, estimate.tool_time[i]);
+		}
+	}
+#endif
+	if (mc_get_checkmode())
+	{
+		mc_toogle_checkmode();
+	}
+	proto_feedback(MSG_FEEDBACK_5);
+	cnc_alarm(EXEC_ALARM_SOFTRESET);
+}
 #endif
 
 static uint8_t running_file_getc(void)
 {
 	uint8_t c = 0;
-#ifdef ENABLE_MAIN_LOOP_MODULES
-	BUFFER_TRY_DEQUEUE(fs_file_buffer, &c);
-#else
-	if (fs_running_file)
+#if (FS_LINE_INDEX_STEP > 0)
+	if (fs_resume_line && fs_running_line >= fs_resume_line && !fs_resume_modes[fs_resume_modes_pos])
+	{
+		fs_resume_end();
+	}
+
+	if (fs_resume_modes[fs_resume_modes_pos])
 	{
-		int avail = fs_available(fs_running_file);
-		if (avail)
+		return (uint8_t)fs_resume_modes[fs_resume_modes_pos++];
+	}
+#endif
+	uint8_t b = fs_readahead_index;
+	if (!fs_readahead_len[b])
+	{
+		running_file_fill();
+	}
+
+	if (fs_readahead_pos < fs_readahead_len[b])
+	{
+		c = fs_readahead_buffer[b][fs_readahead_pos++];
+#ifdef ENABLE_FS_TOKEN_CACHE
+		if (fs_token_cache_active)
+		{
+			fs_token_cache_putc(c);
+		}
+#endif
+#if (FS_LINE_INDEX_STEP > 0)
+		if (fs_line_index_active)
 		{
-			fs_read(fs_running_file, &c, 1);
-			avail--;
+			fs_line_index_update(c);
 		}
-		// auto close file
-		if (!avail)
+		fs_running_eol = (c == '\n');
+		if (fs_running_eol)
 		{
-			fs_close(fs_running_file);
-			fs_running_file = NULL;
+			fs_running_line++;
 		}
+#endif
 	}
+
+	// buffer drained swap to the standby buffer
+	if (fs_readahead_pos >= fs_readahead_len[b])
+	{
+		fs_readahead_len[b] = 0;
+		fs_readahead_pos = 0;
+		fs_readahead_index = b ^ 1;
+#ifndef ENABLE_MAIN_LOOP_MODULES
+		// no background task to do the refill
+		running_file_fill();
 #endif
+		// file ended
+		if (!fs_running_file && !fs_readahead_len[b ^ 1])
+		{
+			// the next chars come from other streams
+			fs_token_cache_replay = false;
+#if (FS_LINE_INDEX_STEP > 0)
+			fs_line_index_close();
+#ifdef FS_ENABLE_JOURNAL
+			fs_journal_end();
+#endif
+#endif
+		}
+	}
+
 	return c;
 }
 
 static uint8_t running_file_available()
 {
-	uint8_t avail = 0;
-#ifdef ENABLE_MAIN_LOOP_MODULES
-	avail = BUFFER_READ_AVAILABLE(fs_file_buffer);
-#else
-	if (fs_running_file)
+	uint8_t b = fs_readahead_index;
+	if (!fs_readahead_len[b])
+	{
+		// never report an empty stream while the file has data or the stream would be dropped
+		running_file_fill();
+	}
+
+	uint16_t avail = (fs_readahead_len[b] - fs_readahead_pos) + fs_readahead_len[b ^ 1];
+#if (FS_LINE_INDEX_STEP > 0)
+	avail += strlen(&fs_resume_modes[fs_resume_modes_pos]);
+#endif
+#ifdef ENABLE_FS_TOKEN_CACHE
+	// the parser is done with the last line
+	if (!avail)
+	{
+		fs_token_cache_end();
+	}
+#endif
+#ifdef ENABLE_JOB_ESTIMATOR
+	if (!avail && fs_estimate_file)
 	{
-		avail = (uint8_t)MIN(255, fs_available(fs_running_file));
+		fs_estimate_end();
 	}
 #endif
-	return avail;
+	return (uint8_t)MIN(255, avail);
 }
 
 static void running_file_clear()
 {
-#ifdef ENABLE_MAIN_LOOP_MODULES
-	BUFFER_CLEAR(fs_file_buffer);
+	fs_readahead_len[0] = 0;
+	fs_readahead_len[1] = 0;
+	fs_readahead_pos = 0;
+	fs_token_cache_replay = false;
+	fs_estimate_file = false;
+#ifdef ENABLE_FS_TOKEN_CACHE
+	// drop the incomplete cache
+	fs_token_cache_abort();
+#endif
+#if (FS_LINE_INDEX_STEP > 0)
+	fs_line_index_close();
+	memset(fs_resume_modes, 0, sizeof(fs_resume_modes));
+	fs_resume_line = 0;
+#ifdef FS_ENABLE_JOURNAL
+	// keep the journal open ended so that the job can be resumed
+	fs_journal_active = false;
+#endif
+	// aborted while catching up
+	if (fs_resume_checkmode)
+	{
+		fs_resume_checkmode = false;
+		if (mc_get_checkmode())
+		{
+			mc_toogle_checkmode();
+		}
+	}
 #endif
 	if (fs_running_file)
 	{
@@ -284,23 +1240,56 @@ static void running_file_clear()
 #ifdef ENABLE_MAIN_LOOP_MODULES
 bool running_file_loop(void *args)
 {
-	if (fs_running_file)
+	// refill the drained buffer while the parser consumes the other
+	running_file_fill();
+	return EVENT_CONTINUE;
+}
+CREATE_EVENT_LISTENER(cnc_dotasks, running_file_loop);
+
+#ifdef FS_ENABLE_JOURNAL
+// appends the executing line to the job journal
+bool fs_journal_loop(void *args)
+{
+	if (!fs_journal_active)
 	{
-		size_t r = BUFFER_WRITE_AVAILABLE(fs_file_buffer);
-		uint8_t tmp[RX_BUFFER_SIZE];
-		size_t read = fs_read(fs_running_file, tmp, r);
-		uint8_t w = 0;
-		BUFFER_WRITE(fs_file_buffer, tmp, read, w);
-		if (read < r || !fs_available(fs_running_file))
-		{
-			fs_close(fs_running_file);
-			fs_running_file = NULL;
-		}
+		return EVENT_CONTINUE;
+	}
+
+#ifndef ENABLE_MAIN_LOOP_SCHEDULER
+	// the scheduler already runs it once every period
+	if (mcu_millis() < fs_journal_next)
+	{
+		return EVENT_CONTINUE;
+	}
+	fs_journal_next = mcu_millis() + FS_JOURNAL_PERIOD_MS;
+#endif
+
+	uint32_t line = itp_get_rt_file_line();
+	if (line && line != fs_journal_line)
+	{
+		fs_journal_line = line;
+		fs_journal_append(FS_JOURNAL_POINT, line, NULL);
 	}
+	return EVENT_CONTINUE;
+}
+CREATE_SCHEDULED_LISTENER(fs_journal_loop, FS_JOURNAL_PERIOD_MS, FS_JOURNAL_WRITE_US);
+#endif
+#endif
 
+#ifdef FS_ENABLE_JOURNAL
+// tags the motion blocks with the running file line
+// the N word of the line is kept for the status report
+bool fs_journal_line_number(void *args)
+{
+	gcode_exec_args_t *ptr = (gcode_exec_args_t *)args;
+	if (fs_journal_active)
+	{
+		// the line ends before the line feed is read for CR+LF
+		ptr->block_data->file_line = (fs_running_eol) ? (fs_running_line - 1) : fs_running_line;
+	}
 	return EVENT_CONTINUE;
 }
-CREATE_EVENT_LISTENER(cnc_dotasks, running_file_loop);
+CREATE_EVENT_LISTENER(gcode_exec_modifier, fs_journal_line_number);
 #endif
 
 static void fs_dir_list(void)
@@ -403,6 +1392,85 @@ void fs_file_print(char *params)
 	proto_print(MSG_EOL);
 }
 
+static bool fs_file_start(const char *file, uint32_t startline, bool resume)
+{
+	fs_file_t *fp = fs_path_parse(&fs_cwd, file, "r");
+
+	if (fp)
+	{
+		startline = MAX(1, startline);
+		proto_info("Running file from line - %lu", startline);
+#ifdef DECL_SERIAL_STREAM
+		char idxpath[FS_PATH_NAME_MAX_LEN];
+		memset(idxpath, 0, sizeof(idxpath));
+		strncpy(idxpath, file, FS_PATH_NAME_MAX_LEN - sizeof(FS_LINE_INDEX_EXT));
+		strcat(idxpath, FS_LINE_INDEX_EXT);
+		if (!fs_file_seek_line(fp, idxpath, startline, resume))
+		{
+			fs_close(fp);
+			proto_info("File read error!");
+			return false;
+		}
+#ifdef FS_ENABLE_JOURNAL
+		fs_resume_return = resume;
+#endif
+#if (defined(FS_ENABLE_JOURNAL) || defined(ENABLE_FS_TOKEN_CACHE))
+		// absolute file path
+		char path[FS_PATH_NAME_MAX_LEN];
+		memset(path, 0, sizeof(path));
+		if (file[0] != '/')
+		{
+			strncpy(path, fs_cwd.full_name, FS_PATH_NAME_MAX_LEN - 2);
+			strcat(path, "/");
+		}
+		strncat(path, file, FS_PATH_NAME_MAX_LEN - strlen(path) - 1);
+#endif
+		fs_token_cache_replay = false;
+#ifdef ENABLE_FS_TOKEN_CACHE
+		// a full run replays the token cache or records it
+		if (startline == 1 && !resume)
+		{
+			fs_file_t *ucb = fs_token_cache_open(path, fp);
+			if (ucb)
+			{
+				fs_close(fp);
+				fp = ucb;
+				fs_token_cache_replay = true;
+			}
+			else
+			{
+				fs_token_cache_start(path, fp);
+			}
+		}
+#endif
+#if (FS_LINE_INDEX_STEP > 0)
+		// (re)build the line index on a full run
+		// the index built while recording the token cache is kept since the cache offsets differ
+		if (startline == 1 && !fs_token_cache_replay)
+		{
+			fs_line_index_start(idxpath, fp);
+		}
+#endif
+		// open a readonly stream
+		// the output is sent to the current holding interface
+		// the file might get closed here (small files) so it is the last use of fp
+		running_file_start(fp);
+		serial_stream_readonly(&running_file_getc, &running_file_available, &running_file_clear);
+#ifdef FS_ENABLE_JOURNAL
+		// the journal stores the absolute path (an estimate is not a job to resume)
+		if (!fs_estimate_file)
+		{
+			fs_journal_start(path);
+		}
+#endif
+#endif
+		return true;
+	}
+
+	proto_info("File read error!");
+	return false;
+}
+
 void fs_file_run(char *params)
 {
 	char *file;
@@ -419,36 +1487,41 @@ void fs_file_run(char *params)
 		file++;
 	}
 
-	fs_file_t *fp = fs_path_parse(&fs_cwd, file, "r");
+	fs_file_start(file, startline, false);
+}
+
+#ifdef FS_ENABLE_JOURNAL
+// resumes the last journaled job from the executing line
+static void fs_journal_resume(void)
+{
+	char path[FS_PATH_NAME_MAX_LEN];
+	fs_journal_record_t record;
+	uint32_t line = 0;
 
+	fs_file_t *fp = fs_journal_open("r");
 	if (fp)
 	{
-		startline = MAX(1, startline);
-		proto_info("Running file from line - %lu", startline);
-#ifdef DECL_SERIAL_STREAM
-#ifdef ENABLE_MAIN_LOOP_MODULES
-		// prefill buffer
-		BUFFER_CLEAR(fs_file_buffer);
-		size_t r = BUFFER_WRITE_AVAILABLE(fs_file_buffer);
-		uint8_t tmp[RX_BUFFER_SIZE];
-		size_t read = fs_read(fs_running_file, tmp, r);
-		uint8_t w = 0;
-		BUFFER_WRITE(fs_file_buffer, tmp, read, w);
-#endif
-		// open a readonly stream
-		// the output is sent to the current holding interface
-		fs_running_file = fp;
-		serial_stream_readonly(&running_file_getc, &running_file_available, &running_file_clear);
-		while (--startline)
+		if (fs_read(fp, (uint8_t *)&record, sizeof(record)) == sizeof(record) && record.type == FS_JOURNAL_START &&
+				fs_read(fp, (uint8_t *)path, FS_PATH_NAME_MAX_LEN) == FS_PATH_NAME_MAX_LEN)
 		{
-			parser_discard_command();
+			while (fs_read(fp, (uint8_t *)&record, sizeof(record)) == sizeof(record))
+			{
+				line = (record.type == FS_JOURNAL_POINT) ? record.line : 0;
+			}
 		}
-#endif
+		fs_close(fp);
+	}
+
+	if (!line)
+	{
+		proto_info("No job to resume");
 		return;
 	}
 
-	proto_info("File read error!");
+	path[FS_PATH_NAME_MAX_LEN - 1] = 0;
+	fs_file_start(path, line, true);
 }
+#endif
 
 /**
  * Handles grbl commands for the SD card
@@ -509,6 +1582,64 @@ bool fs_cmd_parser(void *args)
 		return EVENT_HANDLED;
 	}
 
+#ifdef ENABLE_JOB_ESTIMATOR
+	if (!strcmp("EST", (char *)(cmd->cmd)))
+	{
+		// the command line might have ended already
+		int8_t len = (cmd->next_char == EOL) ? 0 : parser_get_grbl_cmd_arg(params, RX_BUFFER_CAPACITY);
+
+		if (len < 0)
+		{
+			*(cmd->error) = STATUS_INVALID_STATEMENT;
+			return EVENT_HANDLED;
+		}
+
+		char *file = params;
+		while (*file == ' ')
+		{
+			file++;
+		}
+
+		if (!*file)
+		{
+			// streamed program (the first $EST starts the estimate and the next one reports it)
+			if (itp_is_estimating())
+			{
+				fs_estimate_end();
+			}
+			else
+			{
+				fs_estimate_start();
+				proto_feedback(MSG_FEEDBACK_4);
+			}
+		}
+		else
+		{
+			fs_estimate_file = true;
+			fs_estimate_start();
+			if (!fs_file_start(file, 1, false))
+			{
+				// nothing was parsed
+				itp_estimate_t estimate;
+				fs_estimate_file = false;
+				itp_estimate_stop(&estimate);
+				mc_toogle_checkmode();
+			}
+		}
+		*(cmd->error) = STATUS_OK;
+		return EVENT_HANDLED;
+	}
+#endif
+
+#ifdef FS_ENABLE_JOURNAL
+	if (!strcmp("RESUME", (char *)(cmd->cmd)))
+	{
+		fs_journal_resume();
+		*(cmd->error) = STATUS_OK;
+		return EVENT_HANDLED;
+	}
+#endif
+
 	return EVENT_CONTINUE;
 }
 
@@ -559,9 +1690,9 @@ void fs_file_json_api(int client_idx)
 
 	if (http_request_hasargs(client_idx))
 	{
-		char arg = 0;
-		http_request_arg(client_idx, "update", &arg, 1);
-		if (arg && arg != '0')
+		char arg[2] = {0};
+		http_request_arg(client_idx, "update", arg, sizeof(arg));
+		if (arg[0] && arg[0] != '0')
 		{
 			update = true;
 		}
@@ -570,9 +1701,14 @@ void fs_file_json_api(int client_idx)
 	// updated page
 	if (update && http_request_method(client_idx) == HTTP_REQ_GET)
 	{
+		// the embedded page only changes with the firmware
+		if (http_cache_validate(client_idx, "\"" CNC_VERSION "-fsw\""))
+		{
+			return;
+		}
 		uint8_t updatepage[FS_WRITE_GZ_SIZE];
 		rom_memcpy(updatepage, fs_write_page, FS_WRITE_GZ_SIZE);
-		http_send_header(client_idx, "Content-Encoding", "gzip", true);
+		http_send_header(client_idx, "Content-Encoding", "gzip", false);
 		http_send(client_idx, 200, "text/html", (char *)updatepage, FS_WRITE_GZ_SIZE);
 		return;
 	}
@@ -657,20 +1793,8 @@ void fs_file_json_api(int client_idx)
 			}
 			else
 			{
-				file = fs_open(fs_url, "r");
-				uint8_t content[HTTP_MAX_CHUNCK_LEN / sizeof(char)];
-				if (finfo.size > HTTP_MAX_CHUNCK_LEN)
-				{
-					http_send(client_idx, 200, NULL, NULL, 0);
-				}
-				while (fs_available(file))
-				{
-					size_t content_len = fs_read(file, (uint8_t *)content, HTTP_MAX_CHUNCK_LEN / sizeof(char));
-					http_send(client_idx, 200, "application/octet-stream", (char *)content, content_len);
-				}
-				// close the stream
-				http_send(client_idx, 200, "application/octet-stream", NULL, 0);
-				fs_close(file);
+				// cooperative transfer with ETag validation and .gz siblings
+				http_send_file(client_idx, fs_url, "application/octet-stream");
 			}
 		}
 		else
@@ -682,9 +1806,62 @@ void fs_file_json_api(int client_idx)
 	}
 }
 
+/*
+ * Uploads are staged in RAM and written in whole sectors. When the staging
+ * buffer cannot take another socket chunk the request body is held (TCP
+ * back-pressure) and the buffer is drained from the HTTP idle callback.
+ */
+#ifndef FS_UPLOAD_SECTOR_SIZE
+#define FS_UPLOAD_SECTOR_SIZE 512
+#endif
+#ifndef FS_UPLOAD_BUFFER_SIZE
+#define FS_UPLOAD_BUFFER_SIZE (2 * FS_UPLOAD_SECTOR_SIZE + SOCKET_RX_BUFFER_SIZE)
+#endif
+#if (FS_UPLOAD_BUFFER_SIZE < (FS_UPLOAD_SECTOR_SIZE + SOCKET_RX_BUFFER_SIZE))
+#error "FS_UPLOAD_BUFFER_SIZE must hold at least one sector plus one socket RX chunk"
+#endif
+
+static fs_file_t *fs_upload_file;
+static uint8_t fs_upload_buffer[FS_UPLOAD_BUFFER_SIZE];
+static size_t fs_upload_len;
+static uint32_t fs_upload_total;
+static uint32_t fs_upload_start;
+static bool fs_upload_failed;
+
+// writes the staged whole sectors (or everything) and keeps any unwritten tail
+static void fs_upload_flush(bool all)
+{
+	size_t len = (all) ? fs_upload_len : (fs_upload_len - (fs_upload_len % FS_UPLOAD_SECTOR_SIZE));
+
+	while (len && !fs_upload_failed)
+	{
+		size_t written = fs_write(fs_upload_file, fs_upload_buffer, len);
+		if (!written)
+		{
+			fs_upload_failed = true;
+			fs_upload_len = 0;
+			return;
+		}
+		fs_upload_len -= written;
+		memmove(fs_upload_buffer, &fs_upload_buffer[written], fs_upload_len);
+		// a slow drive may accept less, the remainder is retried on the next idle pass
+		if (!all)
+		{
+			return;
+		}
+		len = fs_upload_len;
+	}
+}
+
+static void fs_upload_close(void)
+{
+	fs_close(fs_upload_file);
+	fs_upload_file = NULL;
+	fs_upload_len = 0;
+}
+
 void fs_json_uploader(int client_idx)
 {
-	static fs_file_t *file_upload = NULL;
 	char urlpath[FS_PATH_NAME_MAX_LEN];
 	memset(urlpath, 0, sizeof(urlpath));
 	http_request_uri(client_idx, urlpath, FS_PATH_NAME_MAX_LEN);
@@ -703,28 +1880,74 @@ void fs_json_uploader(int client_idx)
 	}
 
 	http_upload_t upload = http_file_upload_status(client_idx);
+
+	if (http_request_method(client_idx) == HTTP_REQ_POST && (upload.status == HTTP_UPLOAD_START || upload.status == HTTP_UPLOAD_ABORT))
+	{
+		size_t len = strlen(urlpath);
+		if (urlpath[len - 1] != '/' && len < (FS_PATH_NAME_MAX_LEN - 1))
+		{
+			urlpath[len] = '/';
+			len++;
+		}
+		// append the file name
+		http_file_upload_name(client_idx, &urlpath[len], FS_PATH_NAME_MAX_LEN - len);
+	}
+
 	switch (upload.status)
 	{
 	case HTTP_UPLOAD_START:
-		if (http_request_method(client_idx) == HTTP_REQ_POST)
+		fs_upload_close();
+		fs_upload_file = fs_open(file, "w");
+		fs_upload_failed = !fs_upload_file;
+		fs_upload_total = 0;
+		fs_upload_start = mcu_millis();
+		break;
+	case HTTP_UPLOAD_PART:
+		if (upload.datalen > (FS_UPLOAD_BUFFER_SIZE - fs_upload_len))
 		{
-			uint8_t len = strlen(urlpath);
-			if (urlpath[len - 1] != '/' && len < FS_PATH_NAME_MAX_LEN)
-			{
-				urlpath[len] = '/';
-				len++;
-			}
-			// append the file name
-			http_file_upload_name(client_idx, urlpath, FS_PATH_NAME_MAX_LEN - len);
+			// never expected while the hold is honoured
+			fs_upload_flush(true);
+		}
+		if (!fs_upload_failed)
+		{
+			memcpy(&fs_upload_buffer[fs_upload_len], upload.data, upload.datalen);
+			fs_upload_len += upload.datalen;
+			fs_upload_total += upload.datalen;
+		}
+		if ((FS_UPLOAD_BUFFER_SIZE - fs_upload_len) < SOCKET_RX_BUFFER_SIZE)
+		{
+			http_upload_hold(client_idx, true);
 		}
-		file_upload = fs_open(file, "w");
 		break;
-	case HTTP_UPLOAD_PART:
-		fs_write(file_upload, upload.data, upload.datalen);
+	case HTTP_UPLOAD_IDLE:
+		fs_upload_flush(false);
+		if (fs_upload_failed || (FS_UPLOAD_BUFFER_SIZE - fs_upload_len) >= SOCKET_RX_BUFFER_SIZE)
+		{
+			http_upload_hold(client_idx, false);
+		}
+		break;
+	case HTTP_UPLOAD_END:
+		fs_upload_flush(true);
+		fs_upload_close();
+		if (fs_upload_failed)
+		{
+			proto_info("File write error!");
+		}
+		else
+		{
+			uint32_t elapsed = mcu_millis() - fs_upload_start;
+			uint32_t rate = (elapsed) ? (uint32_t)((float)fs_upload_total * 1000.0f / (float)elapsed) : fs_upload_total;
+			proto_info("Uploaded %lu bytes in %lums (%luB/s)", fs_upload_total, elapsed, rate);
+		}
 		break;
 	default:
-		fs_close(file_upload);
-		file_upload = NULL;
+		// aborted, drop the partial file
+		if (fs_upload_file)
+		{
+			fs_upload_close();
+			fs_remove(file);
+		}
+		break;
 	}
 }
 
@@ -885,9 +2108,10 @@ bool system_menu_fs_action(uint8_t action)
 			else
 			{
 				// run file
-				fs_running_file = fs_path_parse(&fs_sm_cwd, fs_filename(&fs_pointed_file), "r");
-				if (fs_running_file)
+				fs_file_t *fp = fs_path_parse(&fs_sm_cwd, fs_filename(&fs_pointed_file), "r");
+				if (fp)
 				{
+					running_file_start(fp);
 					proto_feedback(FS_STR_FILE_RUNNING);
 					system_menu_go_idle();
 					rom_strcpy(buffer, __romstr__(FS_STR_FILE_RUNNING));
@@ -1000,6 +2224,7 @@ void fs_mount(fs_t *drive)
 				drive->next = NULL;
 				break;
 			}
+			ptr = ptr->next;
 		} while (1);
 	}
 
@@ -1018,8 +2243,16 @@ DECL_MODULE(file_system)
 {
 #ifdef ENABLE_PARSER_MODULES
 	ADD_EVENT_LISTENER(grbl_cmd, fs_cmd_parser);
+#ifdef ENABLE_FS_TOKEN_CACHE
+	ADD_EVENT_LISTENER(parse_token_fetch, fs_token_cache_fetch);
+	ADD_EVENT_LISTENER(parse_token_lexed, fs_token_cache_record);
+#endif
 #ifdef ENABLE_MAIN_LOOP_MODULES
 	ADD_EVENT_LISTENER(cnc_dotasks, running_file_loop);
+#ifdef FS_ENABLE_JOURNAL
+	ADD_SCHEDULED_LISTENER(fs_journal_loop);
+	ADD_EVENT_LISTENER(gcode_exec_modifier, fs_journal_line_number);
+#endif
 #else
 #warning "Main loop extensions are not enabled. File running might be slower."
 #endif
@@ -56,9 +56,18 @@ typedef struct
 	bool headers_sent;
 	bool chunked_mode;
 	bool keep_alive;
+	bool accept_gzip;
+	bool upload_hold;
 	uint16_t hdr_len;
 	char hdrs[HTTP_CUSTOM_HEADERS_SIZE];
 
+	/* Conditional request validator (If-None-Match) */
+	char etag_match[HTTP_ETAG_MAX_LEN];
+
+	/* Persistent connection bookkeeping. */
+	uint32_t last_activity;
+	uint16_t pipeline_len;
+	char pipeline[HTTP_PIPELINE_BUFFER_SIZE + 1U];
 
 	/* Cooperative file-response state. */
 	fs_file_t *response_file;
@@ -73,8 +82,19 @@ static socket_if_t *http_srv = NULL;
 /* Client slots align with SOCKET_MAX_CLIENTS from socket.h */
 static http_client_t clients[SOCKET_MAX_CLIENTS];
 
-/* One cooperative file-read buffer shared by all clients. */
-static uint8_t http_file_buffer[HTTP_FILE_CHUNK_SIZE];
+/*
+ * One cooperative file-read buffer shared by all clients. The payload is framed
+ * in place with room for "<hex>\r\n" ahead and "\r\n0\r\n\r\n" behind, so
+ * each chunk leaves in a single socket write.
+ */
+#define HTTP_CHUNK_HEAD_LEN (sizeof(unsigned long) * 2U + 2U)
+#define HTTP_CHUNK_TAIL_LEN 7U
+static uint8_t http_file_buffer[HTTP_CHUNK_HEAD_LEN + HTTP_FILE_CHUNK_SIZE + HTTP_CHUNK_TAIL_LEN];
+#define http_chunk_payload (&http_file_buffer[HTTP_CHUNK_HEAD_LEN])
+
+/* Chunked generated-response bytes staged in the shared buffer. */
+static int http_stage_client = -1;
+static size_t http_stage_len = 0U;
 
 /* Routes */
 static http_route_t routes[HTTP_MAX_HANDLERS];
@@ -102,7 +122,12 @@ static void reset_request_state(int client_idx)
 	clients[client_idx].have_headers = false;
 	clients[client_idx].headers_sent = false;
 	clients[client_idx].chunked_mode = false;
+	clients[client_idx].accept_gzip = false;
+	if (clients[client_idx].upload_hold && http_srv)
+		(void)socket_pause_rx(http_srv, (uint8_t)client_idx, false);
+	clients[client_idx].upload_hold = false;
 	clients[client_idx].hdr_len = 0U;
+	clients[client_idx].etag_match[0] = 0;
 	clients[client_idx].route = NULL;
 }
 
@@ -110,7 +135,13 @@ static void release_client(int client_idx)
 {
 	if (client_idx >= 0 && client_idx < SOCKET_MAX_CLIENTS)
 	{
-		if (clients[client_idx].upl.status == REQ_UPLOAD_INIT_FINISHED)
+		if (http_stage_client == client_idx)
+		{
+			http_stage_client = -1;
+			http_stage_len = 0U;
+		}
+		if (clients[client_idx].upl.status == REQ_UPLOAD_INIT_FINISHED ||
+			clients[client_idx].upl.status == REQ_UPLOAD_START)
 		{
 			/* Notify abort if we die mid-upload */
 			clients[client_idx].fileupl.status = HTTP_UPLOAD_ABORT;
@@ -256,6 +287,7 @@ static const char *http_reason_phrase(int code)
 	case 200: return "OK";
 	case 201: return "Created";
 	case 204: return "No Content";
+	case 304: return "Not Modified";
 	case 400: return "Bad Request";
 	case 404: return "Not Found";
 	case 405: return "Method Not Allowed";
@@ -308,6 +340,17 @@ static int http_send_headers(http_client_t *c,
 	if (result < 0)
 		return result;
 
+	if (c->keep_alive)
+	{
+		length = str_snprintf(line, sizeof(line), "Keep-Alive: timeout=%lu\r\n",
+							  (unsigned long)(HTTP_KEEPALIVE_TIMEOUT_MS / 1000U));
+		if (length <= 0 || (size_t)length >= sizeof(line))
+			return SOCKET_DEVICE_INVALID;
+		result = http_send_bytes(client_idx, line, (size_t)length);
+		if (result < 0)
+			return result;
+	}
+
 	if (c->chunked_mode)
 	{
 		static const char chunked[] = "Transfer-Encoding: chunked\r\n";
@@ -315,7 +358,7 @@ static int http_send_headers(http_client_t *c,
 		if (result < 0)
 			return result;
 	}
-	else
+	else if (code != 304)
 	{
 		length = str_snprintf(line, sizeof(line), "Content-Length: %lu\r\n",
 							  (unsigned long)content_length);
@@ -363,11 +406,90 @@ static void http_complete_response(int client_idx)
 		return;
 	c = &clients[client_idx];
 	if (c->keep_alive)
+	{
 		reset_request_state(client_idx);
+		c->last_activity = mcu_millis();
+	}
 	else if (http_srv)
 		(void)socket_close(http_srv, (uint8_t)client_idx);
 }
 
+/*
+ * Sends length payload bytes already placed at http_chunk_payload as one chunk,
+ * optionally followed by the last-chunk marker, in a single socket write.
+ */
+static int http_send_chunk_frame(int client_idx, size_t length, bool last)
+{
+	char prefix[HTTP_CHUNK_HEAD_LEN + 1U];
+	uint8_t *frame = http_chunk_payload;
+	size_t frame_len = 0U;
+	int prefix_len;
+
+	if (length != 0U)
+	{
+		prefix_len = str_snprintf(prefix, sizeof(prefix), "%lx\r\n", (unsigned long)length);
+		if (prefix_len <= 0 || (size_t)prefix_len >= sizeof(prefix))
+			return SOCKET_DEVICE_INVALID;
+		frame -= prefix_len;
+		memcpy(frame, prefix, (size_t)prefix_len);
+		memcpy(&http_chunk_payload[length], "\r\n", 2U);
+		frame_len = (size_t)prefix_len + length + 2U;
+	}
+	if (last)
+	{
+		memcpy(&frame[frame_len], "0\r\n\r\n", 5U);
+		frame_len += 5U;
+	}
+	if (!frame_len)
+		return SOCKET_DEVICE_OK;
+	return http_send_bytes(client_idx, frame, frame_len);
+}
+
+/* Sends and releases the staged chunk (if any), optionally ending its response. */
+static int http_stage_flush(bool last)
+{
+	int client_idx = http_stage_client;
+	size_t length = http_stage_len;
+
+	http_stage_client = -1;
+	http_stage_len = 0U;
+	if (client_idx < 0)
+		return SOCKET_DEVICE_OK;
+	return http_send_chunk_frame(client_idx, length, last);
+}
+
+/* Coalesces chunked response data, sending full chunks as they fill. */
+static int http_stage_chunk(int client_idx, const uint8_t *data, size_t data_len)
+{
+	int result;
+	size_t length;
+
+	if (http_stage_client != client_idx)
+	{
+		/* a failed flush already closed the other client */
+		(void)http_stage_flush(false);
+		http_stage_client = client_idx;
+	}
+
+	while (data_len)
+	{
+		if (http_stage_len == HTTP_FILE_CHUNK_SIZE)
+		{
+			result = http_stage_flush(false);
+			if (result < 0)
+				return result;
+			http_stage_client = client_idx;
+		}
+		length = MIN(data_len, HTTP_FILE_CHUNK_SIZE - http_stage_len);
+		memcpy(&http_chunk_payload[http_stage_len], data, length);
+		http_stage_len += length;
+		data += length;
+		data_len -= length;
+	}
+
+	return SOCKET_DEVICE_OK;
+}
+
 bool http_send_header(int client_idx, const char *name, const char *data, bool first)
 {
 	http_client_t *c;
@@ -431,8 +553,6 @@ int http_send(int client_idx,
 			  size_t data_len)
 {
 	http_client_t *c;
-	char chunk_prefix[24];
-	int prefix_len;
 	int result;
 	bool finishing = data_len == 0U;
 
@@ -463,32 +583,23 @@ int http_send(int client_idx,
 	if (data_len != 0U)
 	{
 		if (c->chunked_mode)
-		{
-			prefix_len = str_snprintf(chunk_prefix, sizeof(chunk_prefix), "%lx\r\n",
-								  (unsigned long)data_len);
-			if (prefix_len <= 0 || (size_t)prefix_len >= sizeof(chunk_prefix))
-				return SOCKET_DEVICE_INVALID;
-			result = http_send_bytes(client_idx, chunk_prefix, (size_t)prefix_len);
-			if (result < 0)
-				return result;
-		}
-
-		result = http_send_bytes(client_idx, data, data_len);
+			result = http_stage_chunk(client_idx, (const uint8_t *)data, data_len);
+		else
+			result = http_send_bytes(client_idx, data, data_len);
 		if (result < 0)
 			return result;
-		if (c->chunked_mode)
-		{
-			result = http_send_bytes(client_idx, "\r\n", 2U);
-			if (result < 0)
-				return result;
-		}
 	}
 
 	if (finishing)
 	{
 		if (c->chunked_mode)
 		{
-			result = http_send_bytes(client_idx, "0\r\n\r\n", 5U);
+			if (http_stage_client != client_idx)
+			{
+				(void)http_stage_flush(false);
+				http_stage_client = client_idx;
+			}
+			result = http_stage_flush(true);
 			if (result < 0)
 				return result;
 		}
@@ -501,6 +612,8 @@ static void http_progress_file(int client_idx)
 {
 	http_client_t *c;
 	size_t length;
+	size_t window;
+	bool last;
 
 	if (!http_srv || client_idx < 0 || client_idx >= SOCKET_MAX_CLIENTS)
 		return;
@@ -508,28 +621,57 @@ static void http_progress_file(int client_idx)
 	if (!c->response_file)
 		return;
 
-	length = fs_read(c->response_file, http_file_buffer, sizeof(http_file_buffer));
-	if (length == 0U)
-	{
-		fs_close(c->response_file);
-		c->response_file = NULL;
-		(void)http_send(client_idx, 200, NULL, NULL, 0U);
-		return;
-	}
+	/* the file payload reuses the staging area */
+	(void)http_stage_flush(false);
 
-	if (http_send(client_idx, 200, NULL, http_file_buffer, length) < 0)
+	for (window = 0U; window < HTTP_FILE_SEND_WINDOW; window += HTTP_FILE_CHUNK_SIZE)
 	{
-		fs_close(c->response_file);
-		c->response_file = NULL;
-		if (socket_client_is_connected(http_srv, (uint8_t)client_idx))
-			(void)socket_close(http_srv, (uint8_t)client_idx);
+		length = fs_read(c->response_file, http_chunk_payload, HTTP_FILE_CHUNK_SIZE);
+		last = !length || !fs_available(c->response_file);
+		if (http_send_chunk_frame(client_idx, length, last) < 0)
+		{
+			fs_close(c->response_file);
+			c->response_file = NULL;
+			if (socket_client_is_connected(http_srv, (uint8_t)client_idx))
+				(void)socket_close(http_srv, (uint8_t)client_idx);
+			return;
+		}
+		if (last)
+		{
+			fs_close(c->response_file);
+			c->response_file = NULL;
+			http_complete_response(client_idx);
+			return;
+		}
 	}
 }
 
+bool http_cache_validate(int client_idx, const char *etag)
+{
+	http_client_t *c;
+
+	if (!http_srv || client_idx < 0 || client_idx >= SOCKET_MAX_CLIENTS || !etag || !etag[0])
+		return false;
+	c = &clients[client_idx];
+	if (c->headers_sent || !http_send_header(client_idx, "ETag", etag, false))
+		return false;
+	if (!c->etag_match[0] || (strcmp(c->etag_match, "*") && !strstr(c->etag_match, etag)))
+		return false;
+
+	c->chunked_mode = false;
+	if (http_send_headers(c, client_idx, 304, NULL, 0U) >= 0)
+		http_complete_response(client_idx);
+	return true;
+}
+
 bool http_send_file(int client_idx, const char *file_path, const char *content_type)
 {
 	http_client_t *c;
 	fs_file_t *file;
+	fs_file_info_t finfo;
+	char gz_path[FS_PATH_NAME_MAX_LEN];
+	char etag[HTTP_ETAG_MAX_LEN];
+	bool gzip = false;
 	const char *type = content_type ? content_type : "application/octet-stream";
 
 	if (!http_srv || client_idx < 0 || client_idx >= SOCKET_MAX_CLIENTS || !file_path)
@@ -538,6 +680,31 @@ bool http_send_file(int client_idx, const char *file_path, const char *content_t
 	if (c->response_file || c->headers_sent)
 		return false;
 
+	/* Prefer a precompressed sibling when the client accepts it. */
+	if (c->accept_gzip && strlen(file_path) + sizeof(".gz") <= sizeof(gz_path))
+	{
+		strcpy(gz_path, file_path);
+		strcat(gz_path, ".gz");
+		gzip = fs_finfo(gz_path, &finfo) && !finfo.is_dir;
+	}
+	if (gzip)
+		file_path = gz_path;
+	else if (!fs_finfo(file_path, &finfo) || finfo.is_dir)
+	{
+		(void)http_send_str(client_idx, 404, "text/plain", "404 Not Found");
+		(void)http_send(client_idx, 404, "text/plain", NULL, 0U);
+		return false;
+	}
+
+	/* Size and modification time identify the stored representation. */
+	str_snprintf(etag, sizeof(etag), "\"%lu-%lu%s\"", (unsigned long)finfo.size,
+				 (unsigned long)finfo.timestamp, gzip ? "-gz" : "");
+	(void)http_send_header(client_idx, "Vary", "Accept-Encoding", false);
+	if (http_cache_validate(client_idx, etag))
+		return true;
+	if (gzip)
+		(void)http_send_header(client_idx, "Content-Encoding", "gzip", false);
+
 	file = fs_open(file_path, "rb");
 	if (!file)
 	{
@@ -581,6 +748,20 @@ void http_file_upload_name(int client_idx, char *filename, size_t maxlen)
 	filename[maxlen - 1] = '\0';
 }
 
+bool http_upload_hold(int client_idx, bool hold)
+{
+	http_client_t *c;
+	if (!http_srv || client_idx < 0 || client_idx >= SOCKET_MAX_CLIENTS)
+		return false;
+	c = &clients[client_idx];
+	if (hold && c->upl.status != REQ_UPLOAD_START)
+		return false;
+	if (socket_pause_rx(http_srv, (uint8_t)client_idx, hold) != SOCKET_DEVICE_OK)
+		return false;
+	c->upload_hold = hold;
+	return true;
+}
+
 // not necessary
 // char *http_file_upload_buffer(int client_idx, size_t *len)
 // {
@@ -685,6 +866,9 @@ static void handle_upload_bytes(int client_idx, char **buf, size_t *len)
 			c->fileupl.data = NULL;
 			c->fileupl.datalen = 0;
 			c->upl.status = REQ_UPLOAD_FINISH;
+			// the closing boundary still has to be received
+			if (c->upload_hold)
+				(void)http_upload_hold(client_idx, false);
 			if (!c->upl.boundary_len)
 			{
 				*buf = &buffer[*len];
@@ -725,57 +909,52 @@ static void handle_upload_bytes(int client_idx, char **buf, size_t *len)
 
 /* --------------- socket callbacks ----------------- */
 
-static void http_on_connected(uint8_t client_idx, void *protocol)
-{
-	(void)protocol;
-	if (client_idx < SOCKET_MAX_CLIENTS)
-		client_reset(client_idx);
-}
-
-static void http_on_disconnected(uint8_t client_idx, int reason, void *protocol)
+/*
+ * Keeps request bytes that arrive while a file response is still streaming.
+ * If they do not fit the connection is closed (after the current response) and
+ * the client retries the unanswered requests.
+ */
+static void http_pipeline_store(uint8_t client_idx, const char *bytes, size_t len)
 {
-	(void)reason;
-	(void)protocol;
-	if (client_idx < SOCKET_MAX_CLIENTS)
-		release_client(client_idx);
-}
+	http_client_t *c = &clients[client_idx];
 
-/* Advance at most one cooperative file read/send per idle callback. */
-static void http_on_idle(uint8_t client_idx, uint32_t idle_ms, void *protocol)
-{
-	(void)idle_ms;
-	(void)protocol;
-	if (client_idx < SOCKET_MAX_CLIENTS && clients[client_idx].response_file)
-		http_progress_file((int)client_idx);
+	if (len > HTTP_PIPELINE_BUFFER_SIZE - c->pipeline_len)
+	{
+		c->keep_alive = false;
+		if (!c->response_file)
+			(void)socket_close(http_srv, client_idx);
+		return;
+	}
+	memmove(&c->pipeline[c->pipeline_len], bytes, len);
+	c->pipeline_len = (uint16_t)(c->pipeline_len + len);
+	c->pipeline[c->pipeline_len] = 0;
 }
 
-static void http_on_data(uint8_t client_idx,
-					 const uint8_t *data,
-					 size_t data_len,
-					 void *protocol)
+static void http_process(uint8_t client_idx, char *bytes, size_t data_len)
 {
-	http_client_t *c;
-	char *bytes;
-	(void)protocol;
-	if (client_idx >= SOCKET_MAX_CLIENTS || !data || data_len == 0U)
-		return;
-	c = &clients[client_idx];
-	/* HTTP pipelining is deliberately unsupported while a response is active. */
-	if (c->response_file)
-		return;
-	/* Request parser advances the pointer but must treat pointed RX bytes read-only. */
-	bytes = (char *)(uintptr_t)data;
+	http_client_t *c = &clients[client_idx];
+	size_t last_len;
 
 	do
 	{
+		last_len = data_len;
 		// parse request start line
 		if (!c->have_reqline)
 		{
+			// tolerate empty lines between requests
+			while (data_len && !c->req.status && (*bytes == '\r' || *bytes == '\n'))
+			{
+				bytes++;
+				data_len--;
+			}
+			if (!data_len)
+				break;
 			http_request_parse_start(&c->req, &bytes, &data_len);
 			if ((c->req.status == REQ_START_FINISHED))
 			{
 				c->route = match_route(c->req.uri, c->req.method);
 				c->have_reqline = true;
+				c->keep_alive = !c->req.http10;
 			}
 		}
 		else if (!c->have_headers) // parse request headers
@@ -792,6 +971,16 @@ static void http_on_data(uint8_t client_idx,
 						if (strcasestr_local(c->head.value, "close"))
 							c->keep_alive = false;
 					}
+					else if (!strncasecmp_local((char *)"if-none-match", c->head.name, 13) && c->head.value)
+					{
+						strncpy(c->etag_match, c->head.value, sizeof(c->etag_match) - 1);
+						c->etag_match[sizeof(c->etag_match) - 1] = 0;
+						strntrim_local(c->etag_match);
+					}
+					else if (!strncasecmp_local((char *)"accept-encoding", c->head.name, 15) && c->head.value)
+					{
+						c->accept_gzip = (strcasestr_local(c->head.value, "gzip") != NULL);
+					}
 					if (c->head.name[0] == 0)
 					{
 						// empty line
@@ -821,9 +1010,115 @@ static void http_on_data(uint8_t client_idx,
 			handle_upload_bytes(client_idx, &bytes, &data_len);
 		}
 
+		// a fixed body is complete once sent, even without the finishing call
+		if (c->headers_sent && !c->chunked_mode)
+			http_complete_response(client_idx);
+
+		if (!socket_client_is_connected(http_srv, client_idx))
+			return;
+
+		// the next pipelined request waits for the streamed file to finish
+		if (c->response_file && data_len)
+		{
+			http_pipeline_store(client_idx, bytes, data_len);
+			return;
+		}
+
+		// the parser could not consume a malformed start line
+		if (data_len == last_len && !c->have_reqline)
+		{
+			(void)socket_close(http_srv, client_idx);
+			return;
+		}
 	} while (data_len);
 }
 
+static void http_on_connected(uint8_t client_idx, void *protocol)
+{
+	(void)protocol;
+	if (client_idx < SOCKET_MAX_CLIENTS)
+	{
+		client_reset(client_idx);
+		clients[client_idx].last_activity = mcu_millis();
+	}
+}
+
+static void http_on_disconnected(uint8_t client_idx, int reason, void *protocol)
+{
+	(void)reason;
+	(void)protocol;
+	if (client_idx < SOCKET_MAX_CLIENTS)
+		release_client(client_idx);
+}
+
+/*
+ * Sends any staged chunk, advances one file send window, replays pipelined
+ * requests once the connection is free and expires idle persistent connections.
+ */
+static void http_on_idle(uint8_t client_idx, uint32_t idle_ms, void *protocol)
+{
+	http_client_t *c;
+	size_t len;
+	(void)idle_ms;
+	(void)protocol;
+	if (client_idx >= SOCKET_MAX_CLIENTS)
+		return;
+	c = &clients[client_idx];
+
+	(void)http_stage_flush(false);
+	if (c->response_file)
+	{
+		http_progress_file((int)client_idx);
+		return;
+	}
+
+	if (c->upload_hold)
+	{
+		/* let the handler drain; the body resumes once it releases the hold */
+		c->last_activity = mcu_millis();
+		c->fileupl.status = HTTP_UPLOAD_IDLE;
+		c->fileupl.data = NULL;
+		c->fileupl.datalen = 0;
+		maybe_invoke_file_handler(client_idx);
+		return;
+	}
+
+	if (c->pipeline_len)
+	{
+		/* replay in place; a new file response re-stores the tail at the front */
+		len = c->pipeline_len;
+		c->pipeline_len = 0U;
+		http_process(client_idx, c->pipeline, len);
+		(void)http_stage_flush(false);
+		return;
+	}
+
+	if ((mcu_millis() - c->last_activity) > HTTP_KEEPALIVE_TIMEOUT_MS)
+		(void)socket_close(http_srv, client_idx);
+}
+
+static void http_on_data(uint8_t client_idx,
+					 const uint8_t *data,
+					 size_t data_len,
+					 void *protocol)
+{
+	http_client_t *c;
+	(void)protocol;
+	if (client_idx >= SOCKET_MAX_CLIENTS || !data || data_len == 0U)
+		return;
+	c = &clients[client_idx];
+	c->last_activity = mcu_millis();
+	/* Requests pipelined behind an active or queued response keep their order. */
+	if (c->response_file || c->pipeline_len)
+	{
+		http_pipeline_store(client_idx, (const char *)data, data_len);
+		return;
+	}
+	/* Request parser advances the pointer but must treat pointed RX bytes read-only. */
+	http_process(client_idx, (char *)(uintptr_t)data, data_len);
+	(void)http_stage_flush(false);
+}
+
 DECL_MODULE(http_server)
 {
 	RUNONCE
@@ -840,7 +1135,7 @@ DECL_MODULE(http_server)
 		socket_set_protocol(http_srv, clients);
 		socket_add_ondata_handler(http_srv, http_on_data);
 		socket_add_onconnected_handler(http_srv, http_on_connected);
-			socket_add_onidle_handler(http_srv, http_on_idle);
+		socket_add_onidle_handler(http_srv, http_on_idle);
 		socket_add_ondisconnected_handler(http_srv, http_on_disconnected);
 
 		RUNONCE_COMPLETE();
@@ -31,6 +31,7 @@ extern "C"
 #define HTTP_UPLOAD_PART 1U
 #define HTTP_UPLOAD_END 2U
 #define HTTP_UPLOAD_ABORT 3U
+#define HTTP_UPLOAD_IDLE 4U /* held upload: drain buffered data, no new bytes */
 
 #ifndef FS_PATH_NAME_MAX_LEN
 #define FS_PATH_NAME_MAX_LEN 256U
@@ -61,6 +62,38 @@ extern "C"
 #error "HTTP_FILE_CHUNK_SIZE must be in [1, HTTP_MAX_CHUNCK_LEN]"
 #endif
 
+/* Bytes of a cooperative file response sent per idle callback (whole chunks). */
+#ifndef HTTP_FILE_SEND_WINDOW
+#define HTTP_FILE_SEND_WINDOW (4U * HTTP_FILE_CHUNK_SIZE)
+#endif
+
+#if HTTP_FILE_SEND_WINDOW < HTTP_FILE_CHUNK_SIZE
+#error "HTTP_FILE_SEND_WINDOW must be at least HTTP_FILE_CHUNK_SIZE"
+#endif
+
+/* Idle time after which a persistent connection without an active response is closed. */
+#ifndef HTTP_KEEPALIVE_TIMEOUT_MS
+#define HTTP_KEEPALIVE_TIMEOUT_MS 5000U
+#endif
+
+#if HTTP_KEEPALIVE_TIMEOUT_MS < 1000U
+#error "HTTP_KEEPALIVE_TIMEOUT_MS must be at least 1000"
+#endif
+
+/* Largest entity tag kept from an If-None-Match request header. */
+#ifndef HTTP_ETAG_MAX_LEN
+#define HTTP_ETAG_MAX_LEN 48U
+#endif
+
+/* Per-client storage for pipelined request bytes received while a file response is active. */
+#ifndef HTTP_PIPELINE_BUFFER_SIZE
+#define HTTP_PIPELINE_BUFFER_SIZE 256U
+#endif
+
+#if HTTP_PIPELINE_BUFFER_SIZE == 0U || HTTP_PIPELINE_BUFFER_SIZE > UINT16_MAX
+#error "HTTP_PIPELINE_BUFFER_SIZE must be in [1, 65535]"
+#endif
+
 typedef struct http_upload_
 {
 	uint8_t status;       /* One HTTP_UPLOAD_* value. */
@@ -133,12 +166,18 @@ bool http_send_header(int client_idx,
  *
  * Usage is unchanged: a fixed body is sent with one data call followed by an
  * empty finishing call; chunked mode is selected by an initial NULL/empty call,
- * followed by data chunks and an empty finishing call. Header lines, chunk
- * framing and payload bytes are sent with blocking socket_send().
+ * followed by data chunks and an empty finishing call. Header lines and fixed
+ * bodies are sent with blocking socket_send(). Chunked data is coalesced in the
+ * shared file buffer and framed as HTTP_FILE_CHUNK_SIZE chunks; the remainder
+ * is sent by the finishing call or, at the latest, on the next idle callback.
  *
- * Returns data_len for a completed data operation, 0 for prepare/finish, or a
- * negative socket_device_result_t on invalid state, timeout, disconnect, or
- * transport failure. A failed partial HTTP response closes that connection.
+ * Returns data_len for a completed (or staged) data operation, 0 for
+ * prepare/finish, or a negative socket_device_result_t on invalid state,
+ * timeout, disconnect, or transport failure. A failed partial HTTP response
+ * closes that connection.
+ *
+ * HTTP/1.1 connections are persistent unless the client sends
+ * "Connection: close"; HTTP/1.0 clients must request keep-alive explicitly.
  */
 int http_send(int client_idx,
 			  int code,
@@ -157,10 +196,23 @@ static inline int http_send_str(int client_idx,
 }
 
 /*
- * Opens a file and schedules cooperative chunked transfer. Response headers are
- * sent synchronously, then at most one HTTP_FILE_CHUNK_SIZE block is read and
- * sent per idle callback. All clients share one file-read buffer; no per-client
- * file payload buffer or content-type copy is retained.
+ * Stages an ETag response header for the current request. When the request's
+ * If-None-Match lists the same tag (or "*") a bodyless 304 Not Modified is sent
+ * and the response completes; the caller must then not send anything else.
+ * Returns true when 304 was answered, false when a full response is required.
+ */
+bool http_cache_validate(int client_idx, const char *etag);
+
+/*
+ * Opens a file and schedules cooperative chunked transfer. A "<file_path>.gz"
+ * sibling is served instead, with Content-Encoding: gzip, when the client
+ * accepts gzip. The ETag is derived from the served file size and timestamp and
+ * a matching If-None-Match is answered with 304 without reading the file.
+ * Response headers are
+ * sent synchronously, then up to HTTP_FILE_SEND_WINDOW bytes are read and sent
+ * per idle callback, one framed HTTP_FILE_CHUNK_SIZE chunk per socket write.
+ * All clients share one file-read buffer; no per-client file payload buffer or
+ * content-type copy is retained.
  */
 bool http_send_file(int client_idx,
 					const char *file_path,
@@ -175,6 +227,15 @@ http_upload_t http_file_upload_status(int client_idx);
  */
 void http_file_upload_name(int client_idx, char *filename, size_t maxlen);
 
+/*
+ * Holds or releases the request body of an upload in progress. While held the
+ * socket is not read, so TCP flow control pushes back on the sender, and the
+ * route file handler is called with HTTP_UPLOAD_IDLE from the idle callback
+ * until it releases the hold. Holds end with the request.
+ * Returns false for an invalid client or one without an active upload.
+ */
+bool http_upload_hold(int client_idx, bool hold);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,7 +48,8 @@ enum
 	SOCKET_CLIENT_CONNECT_PENDING = 1U << 1,
 	SOCKET_CLIENT_CONNECT_NOTIFIED = 1U << 2,
 	SOCKET_CLIENT_READABLE = 1U << 3,
-	SOCKET_CLIENT_CLOSE_PENDING = 1U << 4
+	SOCKET_CLIENT_CLOSE_PENDING = 1U << 4,
+	SOCKET_CLIENT_RX_PAUSED = 1U << 5
 };
 
 /*
@@ -704,6 +705,25 @@ int socket_close(socket_if_t *socket, uint8_t client_idx)
 	return socket_close_client(client, SOCKET_DEVICE_OK);
 }
 
+int socket_pause_rx(socket_if_t *socket, uint8_t client_idx, bool paused)
+{
+	socket_client_state_t *client = socket_get_client(socket, client_idx, NULL);
+	if (!client || (client->flags & SOCKET_CLIENT_CLOSE_PENDING) != 0U)
+	{
+		return SOCKET_DEVICE_INVALID;
+	}
+
+	if (paused)
+	{
+		client->flags |= SOCKET_CLIENT_RX_PAUSED;
+	}
+	else
+	{
+		client->flags &= (uint8_t)~SOCKET_CLIENT_RX_PAUSED;
+	}
+	return SOCKET_DEVICE_OK;
+}
+
 bool socket_client_is_connected(const socket_if_t *socket,
 									uint8_t client_idx)
 {
@@ -771,8 +791,10 @@ static bool socket_dispatch_client(uint16_t slot)
 	/*
 	 * Pull one bounded RX chunk. Leave READABLE set after a positive read so the
 	 * next round-robin visit can continue draining; clear it on WOULD_BLOCK.
+	 * A paused client keeps READABLE and falls through to its idle callback.
 	 */
-	if ((client->flags & SOCKET_CLIENT_READABLE) != 0U)
+	if ((client->flags & (SOCKET_CLIENT_READABLE | SOCKET_CLIENT_RX_PAUSED)) ==
+		SOCKET_CLIENT_READABLE)
 	{
 		int received;
 
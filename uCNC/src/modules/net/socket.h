@@ -291,6 +291,19 @@ extern "C"
 	 */
 	int socket_close(socket_if_t *socket, uint8_t client_idx);
 
+	/*
+	 * Stops (or resumes) receiving from one client.
+	 *
+	 * While paused no recv() is attempted and no data callback is dispatched; the
+	 * unread bytes stay in the transport so TCP flow control throttles the peer.
+	 * Pending readability is kept and resumes draining once unpaused. Close events
+	 * and idle callbacks are still dispatched. A new connection starts unpaused.
+	 *
+	 * Returns SOCKET_DEVICE_OK or SOCKET_DEVICE_INVALID for an invalid or closing
+	 * client.
+	 */
+	int socket_pause_rx(socket_if_t *socket, uint8_t client_idx, bool paused);
+
 	/*
 	 * Pumps one bounded backend service pass without dispatching application
 	 * callbacks.
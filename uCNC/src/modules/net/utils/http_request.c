@@ -411,6 +411,12 @@ void http_request_parse_start(request_ctx_t *ctx, char **buf, size_t *len)
 			}
 		}
 
+		// the protocol version is the only remaining token of the start line
+		if (ctx->status == REQ_START_QUERY_PARSED && *len >= 8)
+		{
+			ctx->http10 = !strncasecmp_local(buffer, "HTTP/1.0", 8);
+		}
+
 		ctx->status = http_discard_line(ctx->status, REQ_START_QUERY_PARSED, &buffer, len);
 	}
 
@@ -87,6 +87,7 @@ typedef struct
 	char arg_name[MAX_URL_ARGS][MAX_URL_ARG_LEN];
 	char *arg_val[MAX_URL_ARGS];
 	char last_char;
+	bool http10; // request line declared HTTP/1.0 (no implicit keep-alive)
 } request_ctx_t;
 
 typedef struct
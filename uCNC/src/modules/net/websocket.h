@@ -45,6 +45,20 @@ extern "C"
 #define WS_SEND_TYPE (WS_SEND_TXT | WS_SEND_BIN | WS_SEND_PING | WS_SEND_PONG | WS_SEND_CLOSE)
 #define WS_SEND_BROADCAST 128U
 
+/*
+ * Binary G-code channel (ENABLE_WEBSOCKET_GCODE). The first payload byte of a
+ * binary message selects its type:
+ * - WS_GCODE_LINES (client): G-code lines; only bytes previously granted by
+ *   credits may be sent;
+ * - WS_GCODE_REALTIME (client): realtime command bytes, executed on arrival;
+ * - WS_GCODE_CREDIT (server): 16-bit little-endian count of extra RX bytes
+ *   the credit owner may send.
+ * Responses are sent as text messages.
+ */
+#define WS_GCODE_LINES 0x01U
+#define WS_GCODE_REALTIME 0x02U
+#define WS_GCODE_CREDIT 0x81U
+
 #ifndef WEBSOCKET_MAX_CHUNK
 #define WEBSOCKET_MAX_CHUNK SOCKET_MAX_DATA_SIZE
 #endif
@@ -0,0 +1,339 @@
+/*
+	Name: nvm_journal.c
+	Description: Log structured NVM backend for µCNC settings.
+		The NVM contents are kept in RAM and each write appends only the changed bytes as a record to a journal file.
+		When the journal fills up a full snapshot is written to the alternate journal file and the old one is removed.
+		Each journal starts with a generation record and a snapshot so that the newest complete one is always used,
+		even if the power is lost while compacting. The first run migrates the current NVM contents.
+		The journal drive must be mounted before the settings are loaded. Until then reads fail with a settings
+		read error and writes are dropped with a settings write error (the EEPROM is not used as a fallback).
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 19-10-2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include "nvm_journal.h"
+#include <string.h>
+
+#ifdef ENABLE_NVM_JOURNAL
+
+// special record addresses
+#define NVM_JOURNAL_GENERATION 0xFFFF
+#define NVM_JOURNAL_SNAPSHOT_END 0xFFFE
+
+#define NVM_JOURNAL_RECORD_EOF 0
+#define NVM_JOURNAL_RECORD_OK 1
+#define NVM_JOURNAL_RECORD_TORN 2
+
+typedef struct nvm_journal_record_
+{
+	uint16_t address;
+	uint8_t len;
+	uint8_t crc;
+} nvm_journal_record_t;
+
+static uint8_t nvm_journal_image[NVM_STORAGE_SIZE];
+static bool nvm_journal_loaded;
+// active journal file (0 or 1)
+static uint8_t nvm_journal_index;
+static uint32_t nvm_journal_generation;
+static uint32_t nvm_journal_size;
+// range of the bytes changed by the current write
+static uint16_t nvm_journal_change_start;
+static uint16_t nvm_journal_change_end;
+
+static fs_file_t *nvm_journal_open(uint8_t index, const char *mode)
+{
+	char path[] = "/C/nvm0.jnl";
+	path[1] = NVM_JOURNAL_DRIVE;
+	path[6] += index;
+	return fs_open(path, mode);
+}
+
+static void nvm_journal_remove(uint8_t index)
+{
+	char path[] = "/C/nvm0.jnl";
+	path[1] = NVM_JOURNAL_DRIVE;
+	path[6] += index;
+	fs_remove(path);
+}
+
+// crc8 (poly 0x07)
+static uint8_t nvm_journal_crc(const uint8_t *data, uint8_t len, uint8_t crc)
+{
+	while (len--)
+	{
+		crc ^= *data++;
+		for (uint8_t i = 8; i != 0; i--)
+		{
+			crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+		}
+	}
+	return crc;
+}
+
+static uint8_t nvm_journal_record_crc(nvm_journal_record_t *record, const uint8_t *data)
+{
+	uint8_t crc = nvm_journal_crc((uint8_t *)&record->address, sizeof(record->address), 0);
+	crc = nvm_journal_crc(&record->len, sizeof(record->len), crc);
+	return nvm_journal_crc(data, record->len, crc);
+}
+
+static bool nvm_journal_write_record(fs_file_t *fp, uint16_t address, const uint8_t *data, uint8_t len)
+{
+	nvm_journal_record_t record = {address, len, 0};
+	record.crc = nvm_journal_record_crc(&record, data);
+	if (fs_write(fp, (uint8_t *)&record, sizeof(record)) != sizeof(record) || fs_write(fp, data, len) != len)
+	{
+		return false;
+	}
+
+	nvm_journal_size += sizeof(record) + len;
+	return true;
+}
+
+// a record cut by a power loss (or otherwise corrupted) ends the journal
+static uint8_t nvm_journal_read_record(fs_file_t *fp, nvm_journal_record_t *record, uint8_t *data)
+{
+	size_t len = fs_read(fp, (uint8_t *)record, sizeof(nvm_journal_record_t));
+	if (!len)
+	{
+		return NVM_JOURNAL_RECORD_EOF;
+	}
+
+	if (len != sizeof(nvm_journal_record_t) || record->len > NVM_JOURNAL_CHUNK || fs_read(fp, data, record->len) != record->len || nvm_journal_record_crc(record, data) != record->crc)
+	{
+		return NVM_JOURNAL_RECORD_TORN;
+	}
+
+	return NVM_JOURNAL_RECORD_OK;
+}
+
+// returns the generation of a journal with a complete snapshot (or 0)
+static uint32_t nvm_journal_check(uint8_t index)
+{
+	uint8_t data[NVM_JOURNAL_CHUNK];
+	nvm_journal_record_t record;
+	uint32_t generation = 0;
+	fs_file_t *fp = nvm_journal_open(index, "r");
+	if (!fp)
+	{
+		return 0;
+	}
+
+	if (nvm_journal_read_record(fp, &record, data) == NVM_JOURNAL_RECORD_OK && record.address == NVM_JOURNAL_GENERATION && record.len == sizeof(uint32_t))
+	{
+		while (nvm_journal_read_record(fp, &record, data) == NVM_JOURNAL_RECORD_OK)
+		{
+			if (record.address == NVM_JOURNAL_SNAPSHOT_END)
+			{
+				memcpy(&generation, data, sizeof(uint32_t));
+				break;
+			}
+		}
+	}
+
+	fs_close(fp);
+	return generation;
+}
+
+// rebuilds the image from the journal and returns false if the journal ended in a torn record
+static bool nvm_journal_replay(uint8_t index)
+{
+	uint8_t data[NVM_JOURNAL_CHUNK];
+	nvm_journal_record_t record;
+	uint8_t result = NVM_JOURNAL_RECORD_TORN;
+	fs_file_t *fp = nvm_journal_open(index, "r");
+	nvm_journal_size = 0;
+	if (fp)
+	{
+		while ((result = nvm_journal_read_record(fp, &record, data)) == NVM_JOURNAL_RECORD_OK)
+		{
+			nvm_journal_size += sizeof(record) + record.len;
+			if (record.address < NVM_STORAGE_SIZE)
+			{
+				memcpy(&nvm_journal_image[record.address], data, MIN(record.len, NVM_STORAGE_SIZE - record.address));
+			}
+		}
+		fs_close(fp);
+	}
+
+	return (result == NVM_JOURNAL_RECORD_EOF);
+}
+
+// writes a full snapshot of the image to the alternate journal and drops the current one
+static bool nvm_journal_compact(void)
+{
+	uint8_t index = nvm_journal_index ^ 1;
+	uint32_t generation = nvm_journal_generation + 1;
+	fs_file_t *fp = nvm_journal_open(index, "w");
+	if (!fp)
+	{
+		return false;
+	}
+
+	nvm_journal_size = 0;
+	bool ok = nvm_journal_write_record(fp, NVM_JOURNAL_GENERATION, (uint8_t *)&generation, sizeof(uint32_t));
+	for (uint16_t address = 0; ok && address < NVM_STORAGE_SIZE; address += NVM_JOURNAL_CHUNK)
+	{
+		ok = nvm_journal_write_record(fp, address, &nvm_journal_image[address], (uint8_t)MIN(NVM_JOURNAL_CHUNK, NVM_STORAGE_SIZE - address));
+	}
+	// the snapshot is only valid after this record
+	ok = ok && nvm_journal_write_record(fp, NVM_JOURNAL_SNAPSHOT_END, (uint8_t *)&generation, sizeof(uint32_t));
+	fs_close(fp);
+
+	if (!ok)
+	{
+		return false;
+	}
+
+	nvm_journal_remove(nvm_journal_index);
+	nvm_journal_index = index;
+	nvm_journal_generation = generation;
+	return true;
+}
+
+static bool nvm_journal_load(void)
+{
+	if (nvm_journal_loaded)
+	{
+		return true;
+	}
+
+	uint32_t generation[2] = {nvm_journal_check(0), nvm_journal_check(1)};
+	if (generation[0] || generation[1])
+	{
+		nvm_journal_index = (generation[1] > generation[0]) ? 1 : 0;
+		nvm_journal_generation = generation[nvm_journal_index];
+		if (!nvm_journal_replay(nvm_journal_index))
+		{
+			// new records would be appended after the torn one
+			nvm_journal_compact();
+		}
+	}
+	else
+	{
+		// first run (if the drive is not mounted yet the snapshot fails)
+		for (uint16_t i = 0; i < NVM_STORAGE_SIZE; i++)
+		{
+			nvm_journal_image[i] = mcu_eeprom_getc(i);
+		}
+		nvm_journal_index = 1;
+		nvm_journal_generation = 0;
+		if (!nvm_journal_compact())
+		{
+			return false;
+		}
+	}
+
+	nvm_journal_loaded = true;
+	return true;
+}
+
+void nvm_start_read(uint16_t address)
+{
+#ifndef DISABLE_SAFE_SETTINGS
+	if (!nvm_journal_load())
+	{
+		g_settings_error |= SETTINGS_READ_ERROR;
+	}
+#else
+	nvm_journal_load();
+#endif
+}
+
+void nvm_start_write(uint16_t address)
+{
+	nvm_journal_load();
+	nvm_journal_change_start = NVM_STORAGE_SIZE;
+	nvm_journal_change_end = 0;
+}
+
+uint8_t nvm_getc(uint16_t address)
+{
+	if (!nvm_journal_loaded)
+	{
+		return 0;
+	}
+
+	return (address < NVM_STORAGE_SIZE) ? nvm_journal_image[address] : 0;
+}
+
+void nvm_putc(uint16_t address, uint8_t c)
+{
+	if (nvm_journal_loaded && address < NVM_STORAGE_SIZE && nvm_journal_image[address] != c)
+	{
+		nvm_journal_image[address] = c;
+		nvm_journal_change_start = MIN(nvm_journal_change_start, address);
+		nvm_journal_change_end = MAX(nvm_journal_change_end, address + 1);
+	}
+}
+
+void nvm_end_read(void)
+{
+}
+
+void nvm_end_write(void)
+{
+	// the drive is not mounted
+	if (!nvm_journal_loaded)
+	{
+#ifndef DISABLE_SAFE_SETTINGS
+		g_settings_error |= SETTINGS_WRITE_ERROR;
+#endif
+		return;
+	}
+
+	// nothing changed
+	if (nvm_journal_change_start >= nvm_journal_change_end)
+	{
+		return;
+	}
+
+	uint16_t address = nvm_journal_change_start;
+	uint16_t len = nvm_journal_change_end - address;
+	uint16_t records = (len + NVM_JOURNAL_CHUNK - 1) / NVM_JOURNAL_CHUNK;
+	bool ok = false;
+
+	if ((nvm_journal_size + len + records * sizeof(nvm_journal_record_t)) > NVM_JOURNAL_SIZE)
+	{
+		// the snapshot already holds the changes
+		ok = nvm_journal_compact();
+	}
+	else
+	{
+		fs_file_t *fp = nvm_journal_open(nvm_journal_index, "a");
+		if (fp)
+		{
+			ok = true;
+			while (ok && len)
+			{
+				uint8_t chunk = (uint8_t)MIN(len, NVM_JOURNAL_CHUNK);
+				ok = nvm_journal_write_record(fp, address, &nvm_journal_image[address], chunk);
+				address += chunk;
+				len -= chunk;
+			}
+			fs_close(fp);
+		}
+	}
+
+#ifndef DISABLE_SAFE_SETTINGS
+	if (!ok)
+	{
+		g_settings_error |= SETTINGS_WRITE_ERROR;
+	}
+#endif
+}
+
+#endif
@@ -0,0 +1,49 @@
+/*
+	Name: nvm_journal.h
+	Description: Log structured NVM backend for µCNC settings.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 19-10-2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef NVM_JOURNAL_H
+#define NVM_JOURNAL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "../module.h"
+#include "file_system.h"
+
+// drive that holds the journal files (nvm0.jnl and nvm1.jnl)
+#ifndef NVM_JOURNAL_DRIVE
+#define NVM_JOURNAL_DRIVE 'C'
+#endif
+
+// the journal is compacted to a new snapshot when it would grow past this size
+#ifndef NVM_JOURNAL_SIZE
+#define NVM_JOURNAL_SIZE (4 * NVM_STORAGE_SIZE)
+#endif
+
+// max data bytes per record
+#ifndef NVM_JOURNAL_CHUNK
+#define NVM_JOURNAL_CHUNK 64
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,408 @@
+/*
+	Name: ramfs.c
+	Description: RAM backed file system drive for µCNC.
+		Files are kept contiguous in a fixed size arena. Only one file can be open for writing at a time
+		and that file is always moved to the end of the arena so that it can grow without fragmentation.
+		The drive is flat (no sub directories) and the contents are lost on reset.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 19-10-2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include "ramfs.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef ENABLE_RAMFS
+
+typedef struct ramfs_entry_
+{
+	char name[RAMFS_NAME_MAX_LEN];
+	uint32_t start;
+	uint32_t size;
+	uint32_t timestamp;
+} ramfs_entry_t;
+
+typedef struct ramfs_handle_
+{
+	// file entry index (or next entry to list for dirs)
+	uint8_t entry;
+	bool write;
+	uint32_t pos;
+} ramfs_handle_t;
+
+static uint8_t ramfs_arena[RAMFS_SIZE];
+static ramfs_entry_t ramfs_entries[RAMFS_MAX_FILES];
+static uint32_t ramfs_used;
+static int8_t ramfs_writer;
+static fs_t ramfs;
+
+static const char *ramfs_name(const char *path)
+{
+	while (*path == '/')
+	{
+		path++;
+	}
+	return path;
+}
+
+static int8_t ramfs_find(const char *name)
+{
+	for (uint8_t i = 0; i < RAMFS_MAX_FILES; i++)
+	{
+		if (ramfs_entries[i].name[0] && !strncmp(ramfs_entries[i].name, name, RAMFS_NAME_MAX_LEN))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void ramfs_fill_info(uint8_t index, fs_file_info_t *finfo, bool full_path)
+{
+	memset(finfo->full_name, 0, FS_PATH_NAME_MAX_LEN);
+	if (full_path)
+	{
+		finfo->full_name[0] = '/';
+		finfo->full_name[1] = ramfs.drive;
+		finfo->full_name[2] = '/';
+	}
+	strncat(finfo->full_name, ramfs_entries[index].name, RAMFS_NAME_MAX_LEN);
+	finfo->is_dir = false;
+	finfo->size = ramfs_entries[index].size;
+	finfo->timestamp = ramfs_entries[index].timestamp;
+}
+
+static void ramfs_reverse(uint32_t from, uint32_t to)
+{
+	while (from + 1 < to)
+	{
+		uint8_t c = ramfs_arena[from];
+		ramfs_arena[from++] = ramfs_arena[--to];
+		ramfs_arena[to] = c;
+	}
+}
+
+// releases the entry data and compacts the arena
+static void ramfs_delete(uint8_t index)
+{
+	ramfs_entry_t *e = &ramfs_entries[index];
+	uint32_t end = e->start + e->size;
+	memmove(&ramfs_arena[e->start], &ramfs_arena[end], ramfs_used - end);
+	for (uint8_t i = 0; i < RAMFS_MAX_FILES; i++)
+	{
+		if (ramfs_entries[i].name[0] && ramfs_entries[i].start > e->start)
+		{
+			ramfs_entries[i].start -= e->size;
+		}
+	}
+	ramfs_used -= e->size;
+	memset(e, 0, sizeof(ramfs_entry_t));
+}
+
+// moves the entry data to the end of the arena (in place rotation) so it can grow
+static void ramfs_to_tail(uint8_t index)
+{
+	ramfs_entry_t *e = &ramfs_entries[index];
+	uint32_t end = e->start + e->size;
+	if (end == ramfs_used)
+	{
+		return;
+	}
+
+	ramfs_reverse(e->start, end);
+	ramfs_reverse(end, ramfs_used);
+	ramfs_reverse(e->start, ramfs_used);
+	for (uint8_t i = 0; i < RAMFS_MAX_FILES; i++)
+	{
+		if (ramfs_entries[i].name[0] && ramfs_entries[i].start > e->start)
+		{
+			ramfs_entries[i].start -= e->size;
+		}
+	}
+	e->start = ramfs_used - e->size;
+}
+
+static int8_t ramfs_create(const char *name)
+{
+	if (!name[0] || strchr(name, '/') || strlen(name) >= RAMFS_NAME_MAX_LEN)
+	{
+		return -1;
+	}
+
+	for (uint8_t i = 0; i < RAMFS_MAX_FILES; i++)
+	{
+		if (!ramfs_entries[i].name[0])
+		{
+			strcpy(ramfs_entries[i].name, name);
+			ramfs_entries[i].start = ramfs_used;
+			ramfs_entries[i].size = 0;
+			ramfs_entries[i].timestamp = mcu_millis();
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static fs_file_t *ramfs_opendir(const char *path)
+{
+	// flat file system (root only)
+	if (*ramfs_name(path))
+	{
+		return NULL;
+	}
+
+	fs_file_t *fp = (fs_file_t *)calloc(1, sizeof(fs_file_t));
+	ramfs_handle_t *h = (ramfs_handle_t *)calloc(1, sizeof(ramfs_handle_t));
+	if (!fp || !h)
+	{
+		fs_safe_free(fp);
+		fs_safe_free(h);
+		return NULL;
+	}
+
+	fp->file_info.full_name[0] = '/';
+	fp->file_info.full_name[1] = ramfs.drive;
+	fp->file_info.is_dir = true;
+	fp->file_ptr = h;
+	fp->fs_ptr = &ramfs;
+	return fp;
+}
+
+static fs_file_t *ramfs_open(const char *path, const char *mode)
+{
+	const char *name = ramfs_name(path);
+	if (!name[0])
+	{
+		return ramfs_opendir(path);
+	}
+
+	bool write = (mode[0] == 'w' || mode[0] == 'a');
+	// single writer
+	if (write && ramfs_writer >= 0)
+	{
+		return NULL;
+	}
+
+	int8_t index = ramfs_find(name);
+	if (index < 0 && !write)
+	{
+		return NULL;
+	}
+
+	fs_file_t *fp = (fs_file_t *)calloc(1, sizeof(fs_file_t));
+	ramfs_handle_t *h = (ramfs_handle_t *)calloc(1, sizeof(ramfs_handle_t));
+	if (!fp || !h)
+	{
+		fs_safe_free(fp);
+		fs_safe_free(h);
+		return NULL;
+	}
+
+	if (write)
+	{
+		if (index >= 0 && mode[0] == 'w')
+		{
+			ramfs_delete(index);
+			index = -1;
+		}
+
+		if (index < 0)
+		{
+			index = ramfs_create(name);
+			if (index < 0)
+			{
+				fs_safe_free(fp);
+				fs_safe_free(h);
+				return NULL;
+			}
+		}
+
+		ramfs_to_tail(index);
+		ramfs_writer = index;
+		h->write = true;
+		// appends start at the end
+		h->pos = ramfs_entries[index].size;
+	}
+
+	h->entry = index;
+	ramfs_fill_info(index, &fp->file_info, true);
+	fp->file_ptr = h;
+	fp->fs_ptr = &ramfs;
+	return fp;
+}
+
+static size_t ramfs_read(fs_file_t *fp, uint8_t *buffer, size_t len)
+{
+	ramfs_handle_t *h = (ramfs_handle_t *)fp->file_ptr;
+	ramfs_entry_t *e = &ramfs_entries[h->entry];
+	// file was removed meanwhile
+	if (fp->file_info.is_dir || !e->name[0] || h->pos >= e->size)
+	{
+		return 0;
+	}
+
+	len = MIN(len, e->size - h->pos);
+	memcpy(buffer, &ramfs_arena[e->start + h->pos], len);
+	h->pos += len;
+	return len;
+}
+
+static size_t ramfs_write(fs_file_t *fp, const uint8_t *buffer, size_t len)
+{
+	ramfs_handle_t *h = (ramfs_handle_t *)fp->file_ptr;
+	if (!h->write)
+	{
+		return 0;
+	}
+
+	// the writer is always the tail file so it can overwrite and then grow up to the arena end
+	ramfs_entry_t *e = &ramfs_entries[h->entry];
+	uint32_t overwrite = MIN(len, e->size - h->pos);
+	uint32_t grow = MIN(len - overwrite, RAMFS_SIZE - ramfs_used);
+	memcpy(&ramfs_arena[e->start + h->pos], buffer, overwrite + grow);
+	h->pos += overwrite + grow;
+	e->size += grow;
+	ramfs_used += grow;
+	fp->file_info.size = e->size;
+	return overwrite + grow;
+}
+
+static bool ramfs_seek(fs_file_t *fp, uint32_t position)
+{
+	ramfs_handle_t *h = (ramfs_handle_t *)fp->file_ptr;
+	if (fp->file_info.is_dir || position > ramfs_entries[h->entry].size)
+	{
+		return false;
+	}
+
+	h->pos = position;
+	return true;
+}
+
+static int ramfs_available(fs_file_t *fp)
+{
+	ramfs_handle_t *h = (ramfs_handle_t *)fp->file_ptr;
+	ramfs_entry_t *e = &ramfs_entries[h->entry];
+	if (fp->file_info.is_dir || !e->name[0] || h->pos >= e->size)
+	{
+		return 0;
+	}
+
+	return (int)(e->size - h->pos);
+}
+
+static void ramfs_close(fs_file_t *fp)
+{
+	// the handle itself is released by fs_close
+	ramfs_handle_t *h = (ramfs_handle_t *)fp->file_ptr;
+	if (h->write)
+	{
+		ramfs_entries[h->entry].timestamp = mcu_millis();
+		ramfs_writer = -1;
+	}
+}
+
+static bool ramfs_remove(const char *path)
+{
+	int8_t index = ramfs_find(ramfs_name(path));
+	if (index < 0 || index == ramfs_writer)
+	{
+		return false;
+	}
+
+	ramfs_delete(index);
+	return true;
+}
+
+static bool ramfs_mkdir(const char *path)
+{
+	return false;
+}
+
+static bool ramfs_rmdir(const char *path)
+{
+	return false;
+}
+
+static bool ramfs_next_file(fs_file_t *fp, fs_file_info_t *finfo)
+{
+	ramfs_handle_t *h = (ramfs_handle_t *)fp->file_ptr;
+	if (!fp->file_info.is_dir)
+	{
+		return false;
+	}
+
+	while (h->entry < RAMFS_MAX_FILES)
+	{
+		uint8_t i = h->entry++;
+		if (ramfs_entries[i].name[0])
+		{
+			if (finfo)
+			{
+				ramfs_fill_info(i, finfo, false);
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool ramfs_finfo(const char *path, fs_file_info_t *finfo)
+{
+	const char *name = ramfs_name(path);
+	if (!name[0])
+	{
+		memset(finfo, 0, sizeof(fs_file_info_t));
+		finfo->full_name[0] = '/';
+		finfo->is_dir = true;
+		return true;
+	}
+
+	int8_t index = ramfs_find(name);
+	if (index < 0)
+	{
+		return false;
+	}
+
+	ramfs_fill_info(index, finfo, false);
+	return true;
+}
+
+DECL_MODULE(ramfs)
+{
+	ramfs_used = 0;
+	ramfs_writer = -1;
+	memset(ramfs_entries, 0, sizeof(ramfs_entries));
+	ramfs.drive = RAMFS_DRIVE;
+	ramfs.open = ramfs_open;
+	ramfs.read = ramfs_read;
+	ramfs.write = ramfs_write;
+	ramfs.seek = ramfs_seek;
+	ramfs.available = ramfs_available;
+	ramfs.close = ramfs_close;
+	ramfs.remove = ramfs_remove;
+	ramfs.opendir = ramfs_opendir;
+	ramfs.mkdir = ramfs_mkdir;
+	ramfs.rmdir = ramfs_rmdir;
+	ramfs.next_file = ramfs_next_file;
+	ramfs.finfo = ramfs_finfo;
+	ramfs.next = NULL;
+	fs_mount(&ramfs);
+}
+
+#endif
@@ -0,0 +1,53 @@
+/*
+	Name: ramfs.h
+	Description: RAM backed file system drive for µCNC.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 19-10-2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef RAMFS_H
+#define RAMFS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "../module.h"
+#include "file_system.h"
+
+#ifndef RAMFS_DRIVE
+#define RAMFS_DRIVE 'R'
+#endif
+
+// total bytes available for file contents
+#ifndef RAMFS_SIZE
+#define RAMFS_SIZE 4096
+#endif
+
+#ifndef RAMFS_MAX_FILES
+#define RAMFS_MAX_FILES 8
+#endif
+
+#ifndef RAMFS_NAME_MAX_LEN
+#define RAMFS_NAME_MAX_LEN 32
+#endif
+
+	DECL_MODULE(ramfs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif